@@ -0,0 +1,479 @@
+/*
+ * Command Coalescing Example
+ * ----------------------------
+ * Under bursty load a command queue often holds redundant commands for the same receiver,
+ * e.g. "on, off, on" for one Light. Executing each of them costs a call to the device.
+ *
+ * CoalescingDispatcher collects commands for a short window (a number of commands or a time
+ * span) and combines the commands of each receiver before executing anything:
+ * - Every command declares how it combines with the next command for the same receiver:
+ *   keep both, be replaced by it, absorb it, or cancel out with it.
+ * - A window closes when it holds enough commands, or when its time is up. A timer thread
+ *   closes expired windows, so the tail of a burst does not wait for the next command.
+ * - When the window closes, the commands left for each receiver are handed over in a single
+ *   executeBatch() call. Light commands turn that into one device round trip.
+ * - Statistics show how many commands were eliminated.
+ */
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// How a pending command combines with the next command for the same receiver.
+enum class Combine
+{
+    Append,  // Both commands have to run.
+    Replace, // The next command makes the pending one pointless.
+    Absorb,  // The pending command now also does the work of the next one.
+    Cancel   // Together they have no effect.
+};
+
+// Receiver class that performs the actual operations.
+// Every call stands for a round trip to the physical device.
+class Light
+{
+private:
+    bool on_ = false;
+    int brightness_ = 0;
+    long deviceCalls_ = 0;
+
+    void talkToDevice()
+    {
+        ++deviceCalls_;
+        for (int i = 0; i < 1000; ++i)
+        {
+            // Keeps the compiler from removing the loop that stands in for the round trip.
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        }
+    }
+
+public:
+    void turnOn()
+    {
+        talkToDevice();
+        on_ = true;
+    }
+
+    void turnOff()
+    {
+        talkToDevice();
+        on_ = false;
+    }
+
+    void toggle()
+    {
+        talkToDevice();
+        on_ = !on_;
+    }
+
+    void dim(int delta)
+    {
+        talkToDevice();
+        brightness_ += delta;
+    }
+
+    // Applies several changes in one round trip.
+    template <typename Changes>
+    void batch(Changes changes)
+    {
+        talkToDevice();
+        changes(on_, brightness_);
+    }
+
+    bool isOn() const { return on_; }
+    int brightness() const { return brightness_; }
+    long deviceCalls() const { return deviceCalls_; }
+};
+
+// Command interface. Besides execute() a command names its receiver and says how it
+// combines with the command that follows it for that receiver.
+class Command
+{
+public:
+    virtual void execute() = 0;
+    virtual const void *receiver() const = 0;
+    virtual Combine combine(const Command &next)
+    {
+        (void)next;
+        return Combine::Append;
+    }
+
+    // Runs `commands`, which all have this command's receiver and start with this command.
+    // Receivers that accept several operations in one call override this.
+    virtual void executeBatch(const std::vector<std::unique_ptr<Command>> &commands)
+    {
+        for (const auto &command : commands)
+        {
+            command->execute();
+        }
+    }
+
+    virtual ~Command() = default;
+};
+
+// Base for the commands of a Light: a batch becomes a single Light::batch() call.
+class LightCommand : public Command
+{
+protected:
+    Light &light;
+
+public:
+    LightCommand(Light &light) : light(light) {}
+
+    const void *receiver() const override { return &light; }
+
+    // The command's effect on the light's state, without a device call.
+    virtual void change(bool &on, int &brightness) const = 0;
+
+    void executeBatch(const std::vector<std::unique_ptr<Command>> &commands) override
+    {
+        auto changes = [&commands](bool &on, int &brightness)
+        {
+            for (const auto &command : commands)
+            {
+                static_cast<const LightCommand &>(*command).change(on, brightness);
+            }
+        };
+        light.batch(changes);
+    }
+};
+
+// Setting the state is overridden by any later on/off for the same light.
+class LightOnCommand : public LightCommand
+{
+public:
+    LightOnCommand(Light &light) : LightCommand(light) {}
+
+    void execute() override { light.turnOn(); }
+    void change(bool &on, int &) const override { on = true; }
+    Combine combine(const Command &next) override;
+};
+
+class LightOffCommand : public LightCommand
+{
+public:
+    LightOffCommand(Light &light) : LightCommand(light) {}
+
+    void execute() override { light.turnOff(); }
+    void change(bool &on, int &) const override { on = false; }
+    Combine combine(const Command &next) override;
+};
+
+// Two toggles in a row cancel out.
+class ToggleCommand : public LightCommand
+{
+public:
+    ToggleCommand(Light &light) : LightCommand(light) {}
+
+    void execute() override { light.toggle(); }
+    void change(bool &on, int &) const override { on = !on; }
+
+    Combine combine(const Command &next) override
+    {
+        return dynamic_cast<const ToggleCommand *>(&next) ? Combine::Cancel : Combine::Append;
+    }
+};
+
+// Consecutive brightness changes add up.
+class DimCommand : public LightCommand
+{
+private:
+    int delta;
+
+public:
+    DimCommand(Light &light, int delta) : LightCommand(light), delta(delta) {}
+
+    void execute() override { light.dim(delta); }
+    void change(bool &, int &brightness) const override { brightness += delta; }
+
+    Combine combine(const Command &next) override
+    {
+        if (auto dim = dynamic_cast<const DimCommand *>(&next))
+        {
+            delta += dim->delta;
+            return delta == 0 ? Combine::Cancel : Combine::Absorb;
+        }
+        return Combine::Append;
+    }
+};
+
+static bool setsState(const Command &command)
+{
+    return dynamic_cast<const LightOnCommand *>(&command) || dynamic_cast<const LightOffCommand *>(&command);
+}
+
+Combine LightOnCommand::combine(const Command &next)
+{
+    return setsState(next) ? Combine::Replace : Combine::Append;
+}
+
+Combine LightOffCommand::combine(const Command &next)
+{
+    return setsState(next) ? Combine::Replace : Combine::Append;
+}
+
+// What the dispatcher did with the submitted commands.
+struct CoalescingStats
+{
+    long submitted = 0;
+    long executed = 0;
+    long eliminated = 0;
+    long windows = 0;
+    long expired = 0; // Windows closed by the timer rather than by their size.
+    long batches = 0; // executeBatch() calls, one per receiver and window.
+};
+
+// Buffers commands per receiver, combines them and executes the survivors when the window closes.
+// Commands run on the submitting thread when a window fills up, and on the dispatcher's timer
+// thread when a window expires; the two never run at the same time.
+class CoalescingDispatcher
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct ReceiverQueue
+    {
+        std::vector<std::unique_ptr<Command>> commands;
+        bool listed = false; // Already in receivers_ for the current window.
+    };
+
+    std::unordered_map<const void *, ReceiverQueue> pending_;
+    std::vector<const void *> receivers_; // In order of their first command in the window.
+    std::size_t windowSize_;
+    Clock::duration windowTime_;
+    Clock::time_point windowStart_;
+    std::size_t buffered_ = 0;
+    CoalescingStats stats_;
+
+    std::mutex mutex_;
+    std::condition_variable windowOpened_;
+    bool stopping_ = false;
+    std::thread timer_;
+
+    // Closes each window whose time is up.
+    void expireWindows()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_)
+        {
+            if (receivers_.empty())
+            {
+                windowOpened_.wait(lock);
+                continue;
+            }
+            // The window may be flushed and a new one opened while this waits; recheck.
+            Clock::time_point deadline = windowStart_ + windowTime_;
+            windowOpened_.wait_until(lock, deadline);
+            if (!stopping_ && !receivers_.empty() && Clock::now() >= windowStart_ + windowTime_)
+            {
+                flushLocked();
+                ++stats_.expired;
+            }
+        }
+    }
+
+    void flushLocked()
+    {
+        for (const void *receiver : receivers_)
+        {
+            ReceiverQueue &pending = pending_[receiver];
+            if (!pending.commands.empty())
+            {
+                pending.commands.front()->executeBatch(pending.commands);
+                stats_.executed += static_cast<long>(pending.commands.size());
+                ++stats_.batches;
+            }
+            pending.commands.clear();
+            pending.listed = false;
+        }
+        if (!receivers_.empty())
+        {
+            ++stats_.windows;
+        }
+        receivers_.clear();
+        buffered_ = 0;
+    }
+
+public:
+    CoalescingDispatcher(std::size_t windowSize, Clock::duration windowTime)
+        : windowSize_(windowSize), windowTime_(windowTime)
+    {
+        timer_ = std::thread(&CoalescingDispatcher::expireWindows, this);
+    }
+
+    CoalescingDispatcher(const CoalescingDispatcher &) = delete;
+    CoalescingDispatcher &operator=(const CoalescingDispatcher &) = delete;
+
+    ~CoalescingDispatcher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        windowOpened_.notify_one();
+        timer_.join();
+        flush();
+    }
+
+    void submit(std::unique_ptr<Command> command)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++stats_.submitted;
+        bool opened = receivers_.empty();
+        if (opened)
+        {
+            windowStart_ = Clock::now();
+        }
+
+        ReceiverQueue &pending = pending_[command->receiver()];
+        if (!pending.listed)
+        {
+            pending.listed = true;
+            receivers_.push_back(command->receiver());
+        }
+
+        auto &queue = pending.commands;
+        Combine combine = queue.empty() ? Combine::Append : queue.back()->combine(*command);
+        switch (combine)
+        {
+        case Combine::Append:
+            queue.push_back(std::move(command));
+            ++buffered_;
+            break;
+        case Combine::Replace:
+            queue.back() = std::move(command);
+            ++stats_.eliminated;
+            break;
+        case Combine::Absorb:
+            ++stats_.eliminated;
+            break;
+        case Combine::Cancel:
+            queue.pop_back();
+            --buffered_;
+            stats_.eliminated += 2;
+            break;
+        }
+
+        if (buffered_ >= windowSize_)
+        {
+            flushLocked();
+        }
+        else if (opened)
+        {
+            lock.unlock();
+            windowOpened_.notify_one(); // Let the timer start counting down.
+        }
+    }
+
+    // Close the window now: hand the remaining commands to their receivers, one batch each.
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flushLocked();
+    }
+
+    CoalescingStats stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+};
+
+// Generates a bursty, redundant command stream over a set of lights.
+std::vector<std::unique_ptr<Command>> makeBurst(std::vector<Light> &lights, std::mt19937 &random, int size)
+{
+    std::vector<std::unique_ptr<Command>> burst;
+    for (int i = 0; i < size; ++i)
+    {
+        Light &light = lights[random() % lights.size()];
+        switch (random() % 4)
+        {
+        case 0:
+            burst.push_back(std::make_unique<LightOnCommand>(light));
+            break;
+        case 1:
+            burst.push_back(std::make_unique<LightOffCommand>(light));
+            break;
+        case 2:
+            burst.push_back(std::make_unique<ToggleCommand>(light));
+            break;
+        default:
+            burst.push_back(std::make_unique<DimCommand>(light, static_cast<int>(random() % 21) - 10));
+            break;
+        }
+    }
+    return burst;
+}
+
+int main()
+{
+    const int bursts = 200;
+    const int burstSize = 2000;
+
+    // Run the same bursty workload directly and through the dispatcher.
+    std::vector<Light> direct(16), coalesced(16);
+    std::mt19937 directRandom(3), coalescedRandom(3);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int b = 0; b < bursts; ++b)
+    {
+        for (auto &command : makeBurst(direct, directRandom, burstSize))
+        {
+            command->execute();
+        }
+    }
+    std::chrono::duration<double, std::milli> directTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    CoalescingStats stats;
+    {
+        CoalescingDispatcher dispatcher(256, std::chrono::milliseconds(1));
+        for (int b = 0; b < bursts; ++b)
+        {
+            for (auto &command : makeBurst(coalesced, coalescedRandom, burstSize))
+            {
+                dispatcher.submit(std::move(command));
+            }
+        }
+        dispatcher.flush();
+        stats = dispatcher.stats();
+    }
+    std::chrono::duration<double, std::milli> coalescedTime = std::chrono::steady_clock::now() - start;
+
+    bool same = true;
+    long directCalls = 0, coalescedCalls = 0;
+    for (std::size_t i = 0; i < direct.size(); ++i)
+    {
+        same = same && direct[i].isOn() == coalesced[i].isOn() && direct[i].brightness() == coalesced[i].brightness();
+        directCalls += direct[i].deviceCalls();
+        coalescedCalls += coalesced[i].deviceCalls();
+    }
+
+    // The end of a burst: nothing else is submitted, so only the timer can close the window.
+    Light porch;
+    bool tailRan = false;
+    {
+        CoalescingDispatcher dispatcher(256, std::chrono::milliseconds(1));
+        dispatcher.submit(std::make_unique<LightOnCommand>(porch));
+        dispatcher.submit(std::make_unique<DimCommand>(porch, 5));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CoalescingStats tail = dispatcher.stats(); // Also makes the timer's changes visible here.
+        tailRan = tail.expired == 1 && tail.batches == 1 && porch.isOn() && porch.brightness() == 5;
+    }
+
+    std::cout << "Submitted " << stats.submitted << " commands in " << stats.windows << " windows, executed "
+              << stats.executed << " in " << stats.batches << " batches, eliminated " << stats.eliminated << std::endl;
+    std::cout << "Device calls: direct " << directCalls << ", coalesced " << coalescedCalls << std::endl;
+    std::cout << "Time: direct " << directTime.count() << " ms, coalesced " << coalescedTime.count() << " ms" << std::endl;
+    std::cout << "Final light states " << (same ? "match" : "DO NOT match") << std::endl;
+    std::cout << "Tail of a burst " << (tailRan ? "executed by the timer" : "NOT executed") << std::endl;
+
+    return same && tailRan ? 0 : 1;
+}
@@ -0,0 +1,529 @@
+/*
+ * Command Executor Example
+ * --------------------------
+ * In the basic Command Pattern the invoker runs a command synchronously on the caller's thread.
+ * Because a command is an object, it can just as well be queued and run somewhere else.
+ *
+ * CommandExecutor runs commands on a pool of worker threads:
+ * - Any number of producer threads submit commands into lock-free bounded MPMC queues.
+ * - Every receiver is mapped to one queue, so commands for the same Light run in the
+ *   order they were submitted, while commands for different receivers run in parallel.
+ * - Workers dequeue in batches to amortize the cost of touching the shared queue.
+ * - The executor records the time each command spent between submit and completion in a
+ *   fixed-size histogram per worker and reports throughput and latency percentiles, so its
+ *   memory does not grow with the number of commands run.
+ */
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <array>
+#include <cstdint>
+
+// Command interface that declares the execute method.
+// receiver() identifies the object the command acts on; commands with the same receiver keep their order.
+class Command
+{
+public:
+    virtual void execute() = 0;
+    virtual const void *receiver() const = 0;
+    virtual ~Command() = default;
+};
+
+// Receiver class that performs the actual operations.
+// It counts switches and notices when it is asked to enter the state it is already in.
+class Light
+{
+private:
+    bool on_ = false;
+    long switches_ = 0;
+    long redundant_ = 0;
+
+public:
+    void turnOn()
+    {
+        redundant_ += on_ ? 1 : 0;
+        on_ = true;
+        ++switches_;
+    }
+
+    void turnOff()
+    {
+        redundant_ += on_ ? 0 : 1;
+        on_ = false;
+        ++switches_;
+    }
+
+    bool isOn() const { return on_; }
+    long switches() const { return switches_; }
+    long redundant() const { return redundant_; }
+};
+
+// Concrete command for turning on the light.
+class LightOnCommand : public Command
+{
+private:
+    Light &light;
+
+public:
+    LightOnCommand(Light &light) : light(light) {}
+
+    void execute() override
+    {
+        light.turnOn();
+    }
+
+    const void *receiver() const override
+    {
+        return &light;
+    }
+};
+
+// Concrete command for turning off the light.
+class LightOffCommand : public Command
+{
+private:
+    Light &light;
+
+public:
+    LightOffCommand(Light &light) : light(light) {}
+
+    void execute() override
+    {
+        light.turnOff();
+    }
+
+    const void *receiver() const override
+    {
+        return &light;
+    }
+};
+
+// Bounded multi-producer multi-consumer queue (Dmitry Vyukov's algorithm).
+// Every cell carries a sequence number telling producers and consumers whose turn it is.
+template <typename T>
+class MpmcQueue
+{
+private:
+    struct alignas(64) Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::vector<Cell> cells_;
+    std::size_t mask_;
+    alignas(64) std::atomic<std::size_t> enqueuePos_{0};
+    alignas(64) std::atomic<std::size_t> dequeuePos_{0};
+
+public:
+    // Capacity must be a power of two.
+    explicit MpmcQueue(std::size_t capacity) : cells_(capacity), mask_(capacity - 1)
+    {
+        for (std::size_t i = 0; i < capacity; ++i)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(T value)
+    {
+        std::size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell &cell = cells_[pos & mask_];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // Full.
+            }
+            else
+            {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T &value)
+    {
+        std::size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell &cell = cells_[pos & mask_];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    value = std::move(cell.value);
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // Empty.
+            }
+            else
+            {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// Latency counts in logarithmic buckets: 16 buckets per power of two, so every value is
+// known to within 1/16 (about 6%) in constant memory, however many values are recorded.
+class LatencyHistogram
+{
+public:
+    void record(std::uint64_t nanos)
+    {
+        ++counts_[bucketOf(nanos)];
+        ++count_;
+        max_ = std::max(max_, nanos);
+    }
+
+    void merge(const LatencyHistogram &other)
+    {
+        for (std::size_t i = 0; i < kBuckets; ++i)
+        {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    std::uint64_t count() const { return count_; }
+    std::uint64_t max() const { return max_; }
+
+    // Upper bound of the bucket holding the value at fraction p of the sorted values.
+    std::uint64_t percentile(double p) const
+    {
+        if (count_ == 0)
+        {
+            return 0;
+        }
+        std::uint64_t rank = static_cast<std::uint64_t>(p * static_cast<double>(count_ - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i)
+        {
+            seen += counts_[i];
+            if (seen >= rank)
+            {
+                return std::min(upperBound(i), max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    static constexpr unsigned kSubBits = 4;
+    static constexpr std::uint64_t kSub = std::uint64_t(1) << kSubBits;
+    static constexpr std::size_t kBuckets = kSub + (64 - kSubBits) * kSub;
+
+    std::array<std::uint64_t, kBuckets> counts_{};
+    std::uint64_t count_ = 0;
+    std::uint64_t max_ = 0;
+
+    static unsigned log2Floor(std::uint64_t value)
+    {
+        unsigned log = 0;
+        for (unsigned step = 32; step > 0; step /= 2)
+        {
+            if (value >> step)
+            {
+                value >>= step;
+                log += step;
+            }
+        }
+        return log;
+    }
+
+    // Values below kSub get a bucket each; above, each power of two is split into kSub buckets.
+    static std::size_t bucketOf(std::uint64_t value)
+    {
+        if (value < kSub)
+        {
+            return static_cast<std::size_t>(value);
+        }
+        unsigned shift = log2Floor(value) - kSubBits;
+        return static_cast<std::size_t>(kSub + shift * kSub + ((value >> shift) - kSub));
+    }
+
+    static std::uint64_t upperBound(std::size_t bucket)
+    {
+        if (bucket < kSub)
+        {
+            return bucket;
+        }
+        unsigned shift = static_cast<unsigned>((bucket - kSub) / kSub);
+        std::uint64_t lower = (kSub + (bucket - kSub) % kSub) << shift;
+        return lower + ((std::uint64_t(1) << shift) - 1);
+    }
+};
+
+// Throughput and latency observed by an executor.
+struct ExecutorReport
+{
+    long executed = 0;
+    double seconds = 0;
+    double p50Micros = 0;
+    double p99Micros = 0;
+    double p999Micros = 0;
+    double maxMicros = 0;
+};
+
+// Runs submitted commands on a pool of worker threads, preserving per-receiver order.
+class CommandExecutor
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Task
+    {
+        std::shared_ptr<Command> command;
+        Clock::time_point submitted;
+    };
+
+    static constexpr std::size_t kBatchSize = 32;
+
+    std::vector<std::unique_ptr<MpmcQueue<Task>>> lanes_;
+    // Per worker, in nanoseconds. Each on its own cache lines, since its worker writes it
+    // after every command.
+    struct alignas(64) WorkerLatencies
+    {
+        LatencyHistogram histogram;
+    };
+    std::vector<WorkerLatencies> latencies_;
+    std::vector<std::thread> workers_;
+    std::atomic<bool> stopping_{false};
+    Clock::time_point started_ = Clock::now();
+    Clock::time_point stopped_;
+
+    // One lane per worker; a receiver always maps to the same lane.
+    MpmcQueue<Task> &laneFor(const void *receiver)
+    {
+        std::size_t hash = std::hash<const void *>()(receiver);
+        return *lanes_[(hash ^ (hash >> 7)) % lanes_.size()];
+    }
+
+    void workerLoop(std::size_t index)
+    {
+        MpmcQueue<Task> &lane = *lanes_[index];
+        LatencyHistogram &latencies = latencies_[index].histogram;
+        Task batch[kBatchSize];
+        int idleRounds = 0;
+
+        while (true)
+        {
+            // Read the flag before polling: once it is set, every command submitted before
+            // shutdown() is already in the lane, so an empty poll afterwards means fully drained.
+            bool stopping = stopping_.load(std::memory_order_acquire);
+            std::size_t count = 0;
+            while (count < kBatchSize && lane.tryPop(batch[count]))
+            {
+                ++count;
+            }
+
+            if (count == 0)
+            {
+                if (stopping)
+                {
+                    return;
+                }
+                // Back off gradually: spin, then yield, then sleep.
+                if (++idleRounds > 64)
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+                else if (idleRounds > 16)
+                {
+                    std::this_thread::yield();
+                }
+                continue;
+            }
+
+            idleRounds = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                batch[i].command->execute();
+                auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - batch[i].submitted);
+                latencies.record(static_cast<std::uint64_t>(latency.count()));
+                batch[i].command.reset();
+            }
+        }
+    }
+
+public:
+    // queueCapacity is per worker and must be a power of two.
+    explicit CommandExecutor(unsigned workerCount = std::thread::hardware_concurrency(),
+                             std::size_t queueCapacity = 4096)
+    {
+        workerCount = std::max(1u, workerCount);
+        for (unsigned i = 0; i < workerCount; ++i)
+        {
+            lanes_.push_back(std::make_unique<MpmcQueue<Task>>(queueCapacity));
+        }
+        latencies_.resize(workerCount);
+        for (unsigned i = 0; i < workerCount; ++i)
+        {
+            workers_.emplace_back(&CommandExecutor::workerLoop, this, i);
+        }
+    }
+
+    CommandExecutor(const CommandExecutor &) = delete;
+    CommandExecutor &operator=(const CommandExecutor &) = delete;
+
+    ~CommandExecutor()
+    {
+        shutdown();
+    }
+
+    // Queue a command. Safe to call from any thread; waits while the receiver's lane is full.
+    void submit(const std::shared_ptr<Command> &command)
+    {
+        MpmcQueue<Task> &lane = laneFor(command->receiver());
+        Task task{command, Clock::now()};
+        while (!lane.tryPush(task))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // Run every queued command and stop the workers. Producers must have stopped submitting.
+    void shutdown()
+    {
+        if (stopping_.exchange(true, std::memory_order_acq_rel))
+        {
+            return;
+        }
+        for (auto &worker : workers_)
+        {
+            worker.join();
+        }
+        stopped_ = Clock::now();
+    }
+
+    // Available after shutdown().
+    ExecutorReport report() const
+    {
+        LatencyHistogram all;
+        for (const auto &latencies : latencies_)
+        {
+            all.merge(latencies.histogram);
+        }
+
+        ExecutorReport report;
+        report.executed = static_cast<long>(all.count());
+        report.seconds = std::chrono::duration<double>(stopped_ - started_).count();
+        report.p50Micros = all.percentile(0.50) / 1000.0;
+        report.p99Micros = all.percentile(0.99) / 1000.0;
+        report.p999Micros = all.percentile(0.999) / 1000.0;
+        report.maxMicros = all.max() / 1000.0;
+        return report;
+    }
+};
+
+// Invoker class that holds a command and hands it to the executor when pressed.
+class RemoteControl
+{
+private:
+    CommandExecutor &executor;
+    std::shared_ptr<Command> command;
+
+public:
+    RemoteControl(CommandExecutor &executor) : executor(executor) {}
+
+    void setCommand(const std::shared_ptr<Command> &cmd)
+    {
+        command = cmd;
+    }
+
+    void pressButton()
+    {
+        if (command)
+        {
+            executor.submit(command);
+        }
+    }
+};
+
+int main()
+{
+    const unsigned producerCount = 4;
+    const unsigned lightsPerProducer = 8;
+    const int pressesPerLight = 20000;
+
+    std::vector<Light> lights(producerCount * lightsPerProducer);
+    CommandExecutor executor(std::max(2u, std::thread::hardware_concurrency()));
+
+    // Every producer owns a few lights and switches each of them on and off alternately.
+    // If two commands for one light were ever reordered, the light would see a redundant switch.
+    std::vector<std::thread> producers;
+    for (unsigned p = 0; p < producerCount; ++p)
+    {
+        producers.emplace_back([&, p]()
+                               {
+            RemoteControl remote(executor);
+            std::vector<std::shared_ptr<Command>> onCommands, offCommands;
+            for (unsigned l = 0; l < lightsPerProducer; ++l)
+            {
+                Light &light = lights[p * lightsPerProducer + l];
+                onCommands.push_back(std::make_shared<LightOnCommand>(light));
+                offCommands.push_back(std::make_shared<LightOffCommand>(light));
+            }
+            for (int i = 0; i < pressesPerLight; ++i)
+            {
+                for (unsigned l = 0; l < lightsPerProducer; ++l)
+                {
+                    remote.setCommand(i % 2 == 0 ? onCommands[l] : offCommands[l]);
+                    remote.pressButton();
+                }
+            } });
+    }
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+    executor.shutdown();
+
+    long switches = 0, redundant = 0;
+    for (const auto &light : lights)
+    {
+        switches += light.switches();
+        redundant += light.redundant();
+    }
+
+    ExecutorReport report = executor.report();
+    std::cout << "Executed " << report.executed << " commands (" << switches << " switches, "
+              << redundant << " out of order)" << std::endl;
+    std::cout << "Throughput: " << static_cast<long>(report.executed / report.seconds) << " commands/s" << std::endl;
+    std::cout << "Latency us: p50 " << report.p50Micros << ", p99 " << report.p99Micros
+              << ", p99.9 " << report.p999Micros << ", max " << report.maxMicros << std::endl;
+
+    long expected = static_cast<long>(producerCount) * lightsPerProducer * pressesPerLight;
+    bool ok = redundant == 0 && report.executed == expected;
+    if (report.executed != expected)
+    {
+        std::cout << "Lost " << expected - report.executed << " commands" << std::endl;
+    }
+    return ok ? 0 : 1;
+}
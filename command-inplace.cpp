@@ -0,0 +1,362 @@
+/*
+ * Inline Command Example
+ * ------------------------
+ * The classic Command Pattern allocates every command on the heap and shares it through
+ * a std::shared_ptr, so each command costs an allocation, an atomic reference count and
+ * a virtual call.
+ *
+ * InplaceCommand is a type-erased command with a fixed inline buffer:
+ * - Any callable (a lambda, or one of the command classes below) that fits in the buffer is
+ *   stored directly inside the InplaceCommand, so creating one never touches the heap.
+ *   Callables that do not fit are rejected at compile time.
+ * - Calling it goes through a single function pointer instead of a virtual call on a
+ *   heap object.
+ * - Because it is a plain value it can live directly in a queue slot.
+ *
+ * RemoteControl and CommandQueue accept InplaceCommand. main() compares construction,
+ * dispatch and destruction cost against the shared_ptr<Command> approach.
+ */
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+#include <chrono>
+
+// Command interface of the classic approach, kept for the comparison.
+class Command
+{
+public:
+    virtual void execute() = 0;
+    virtual ~Command() = default;
+};
+
+// Receiver class that performs the actual operations.
+class Light
+{
+private:
+    bool on_ = false;
+    long switches_ = 0;
+
+public:
+    void turnOn()
+    {
+        on_ = true;
+        ++switches_;
+    }
+
+    void turnOff()
+    {
+        on_ = false;
+        ++switches_;
+    }
+
+    bool isOn() const { return on_; }
+    long switches() const { return switches_; }
+};
+
+// Classic heap-allocated commands.
+class LightOnCommand : public Command
+{
+private:
+    Light &light;
+
+public:
+    LightOnCommand(Light &light) : light(light) {}
+
+    void execute() override
+    {
+        light.turnOn();
+    }
+};
+
+class LightOffCommand : public Command
+{
+private:
+    Light &light;
+
+public:
+    LightOffCommand(Light &light) : light(light) {}
+
+    void execute() override
+    {
+        light.turnOff();
+    }
+};
+
+// Type-erased command stored in a fixed inline buffer.
+template <std::size_t Capacity = 3 * sizeof(void *)>
+class BasicInplaceCommand
+{
+private:
+    // Operations of the stored callable. One static table per callable type.
+    struct Operations
+    {
+        void (*invoke)(void *storage);
+        void (*moveTo)(void *from, void *to); // Move-construct into `to`, destroy `from`.
+        void (*destroy)(void *storage);
+    };
+
+    template <typename Callable>
+    static const Operations *operationsFor()
+    {
+        static const Operations operations{
+            [](void *storage)
+            { (*static_cast<Callable *>(storage))(); },
+            [](void *from, void *to)
+            {
+                new (to) Callable(std::move(*static_cast<Callable *>(from)));
+                static_cast<Callable *>(from)->~Callable();
+            },
+            [](void *storage)
+            { static_cast<Callable *>(storage)->~Callable(); }};
+        return &operations;
+    }
+
+    alignas(void *) unsigned char storage_[Capacity];
+    const Operations *operations_ = nullptr;
+
+public:
+    BasicInplaceCommand() = default;
+
+    template <typename Callable,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<Callable>, BasicInplaceCommand>::value>>
+    BasicInplaceCommand(Callable &&callable)
+    {
+        using Stored = std::decay_t<Callable>;
+        static_assert(sizeof(Stored) <= Capacity, "command does not fit in the inline buffer");
+        static_assert(alignof(Stored) <= alignof(void *), "command is over-aligned");
+        static_assert(std::is_nothrow_move_constructible<Stored>::value, "command must be nothrow movable");
+
+        new (storage_) Stored(std::forward<Callable>(callable));
+        operations_ = operationsFor<Stored>();
+    }
+
+    BasicInplaceCommand(BasicInplaceCommand &&other) noexcept : operations_(other.operations_)
+    {
+        if (operations_)
+        {
+            operations_->moveTo(other.storage_, storage_);
+            other.operations_ = nullptr;
+        }
+    }
+
+    BasicInplaceCommand &operator=(BasicInplaceCommand &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            if (other.operations_)
+            {
+                other.operations_->moveTo(other.storage_, storage_);
+                operations_ = other.operations_;
+                other.operations_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    BasicInplaceCommand(const BasicInplaceCommand &) = delete;
+    BasicInplaceCommand &operator=(const BasicInplaceCommand &) = delete;
+
+    ~BasicInplaceCommand()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        if (operations_)
+        {
+            operations_->destroy(storage_);
+            operations_ = nullptr;
+        }
+    }
+
+    void execute()
+    {
+        operations_->invoke(storage_);
+    }
+
+    explicit operator bool() const
+    {
+        return operations_ != nullptr;
+    }
+};
+
+using InplaceCommand = BasicInplaceCommand<>;
+
+// Inline counterparts of the classic commands: small callables with no base class.
+class TurnOn
+{
+private:
+    Light *light;
+
+public:
+    TurnOn(Light &light) : light(&light) {}
+
+    void operator()() const
+    {
+        light->turnOn();
+    }
+};
+
+class TurnOff
+{
+private:
+    Light *light;
+
+public:
+    TurnOff(Light &light) : light(&light) {}
+
+    void operator()() const
+    {
+        light->turnOff();
+    }
+};
+
+// Invoker class that holds a command and triggers its execution.
+class RemoteControl
+{
+private:
+    InplaceCommand command;
+
+public:
+    void setCommand(InplaceCommand cmd)
+    {
+        command = std::move(cmd);
+    }
+
+    void pressButton()
+    {
+        if (command)
+        {
+            command.execute();
+        }
+    }
+};
+
+// Bounded FIFO of commands stored by value in its slots.
+class CommandQueue
+{
+private:
+    std::vector<InplaceCommand> slots_;
+    std::size_t head_ = 0;
+    std::size_t size_ = 0;
+
+public:
+    explicit CommandQueue(std::size_t capacity) : slots_(capacity) {}
+
+    bool push(InplaceCommand command)
+    {
+        if (size_ == slots_.size())
+        {
+            return false;
+        }
+        slots_[(head_ + size_) % slots_.size()] = std::move(command);
+        ++size_;
+        return true;
+    }
+
+    // Execute and destroy every queued command in order.
+    void runAll()
+    {
+        for (; size_ > 0; --size_)
+        {
+            InplaceCommand &command = slots_[head_];
+            command.execute();
+            command.reset();
+            head_ = (head_ + 1) % slots_.size();
+        }
+    }
+};
+
+// Times one phase of the comparison and returns the cost per command.
+template <typename Round>
+double nanosPerCommand(std::size_t n, Round round)
+{
+    auto start = std::chrono::steady_clock::now();
+    round();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / n;
+}
+
+int main()
+{
+    Light livingRoomLight;
+    RemoteControl remote;
+
+    // Turn the light on
+    remote.setCommand(TurnOn(livingRoomLight));
+    remote.pressButton();
+    std::cout << "The light is " << (livingRoomLight.isOn() ? "on" : "off") << std::endl;
+
+    // Any small lambda works as a command too.
+    remote.setCommand([&livingRoomLight]()
+                      { livingRoomLight.turnOff(); });
+    remote.pressButton();
+    std::cout << "The light is " << (livingRoomLight.isOn() ? "on" : "off") << std::endl;
+
+    // Compare both approaches on a million commands: construct, dispatch, destroy.
+    const std::size_t n = 1000000;
+    std::vector<Light> lights(64);
+
+    std::vector<std::shared_ptr<Command>> heapCommands;
+    heapCommands.reserve(n);
+    double construct = nanosPerCommand(n, [&]()
+                                       {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            Light &light = lights[i % lights.size()];
+            if (i % 2)
+                heapCommands.push_back(std::make_shared<LightOnCommand>(light));
+            else
+                heapCommands.push_back(std::make_shared<LightOffCommand>(light));
+        } });
+    double dispatch = nanosPerCommand(n, [&]()
+                                      {
+        for (auto &command : heapCommands)
+            command->execute(); });
+    double destroy = nanosPerCommand(n, [&]()
+                                     { heapCommands.clear(); });
+    std::cout << "shared_ptr<Command>: construct " << construct << " ns, dispatch " << dispatch
+              << " ns, destroy " << destroy << " ns" << std::endl;
+
+    std::vector<InplaceCommand> inlineCommands;
+    inlineCommands.reserve(n);
+    construct = nanosPerCommand(n, [&]()
+                                {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            Light &light = lights[i % lights.size()];
+            if (i % 2)
+                inlineCommands.emplace_back(TurnOn(light));
+            else
+                inlineCommands.emplace_back(TurnOff(light));
+        } });
+    dispatch = nanosPerCommand(n, [&]()
+                               {
+        for (auto &command : inlineCommands)
+            command.execute(); });
+    destroy = nanosPerCommand(n, [&]()
+                              { inlineCommands.clear(); });
+    std::cout << "InplaceCommand:      construct " << construct << " ns, dispatch " << dispatch
+              << " ns, destroy " << destroy << " ns" << std::endl;
+
+    // Commands stored directly in queue slots.
+    CommandQueue queue(1024);
+    double queued = nanosPerCommand(n, [&]()
+                                    {
+        for (std::size_t i = 0; i < n; i += 1024)
+        {
+            for (std::size_t j = 0; j < 1024; ++j)
+                queue.push(TurnOn(lights[j % lights.size()]));
+            queue.runAll();
+        } });
+    std::cout << "CommandQueue push + run: " << queued << " ns per command" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,396 @@
+/*
+ * Command Pattern with Undo/Redo History
+ * ----------------------------------------
+ * Commands that know how to reverse themselves make undo and redo possible.
+ * CommandHistory keeps the executed commands and its snapshots under a hard memory limit:
+ * - Commands are constructed in place inside fixed-size slots of a single buffer (an arena
+ *   used as a ring), so recording a command does not allocate.
+ * - When the buffer is full the oldest command is forgotten.
+ * - undo() and redo() touch only one slot, so they cost the same however long the history is.
+ * - Every few commands the history takes a snapshot of the receivers. Jumping far back
+ *   restores the nearest snapshot and replays at most a few commands, instead of undoing
+ *   thousands of them one by one.
+ */
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <climits>
+#include <stdexcept>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <random>
+#include <chrono>
+
+// Command interface that declares execute and its inverse.
+class Command
+{
+public:
+    virtual void execute() = 0;
+    virtual void undo() = 0;
+    virtual ~Command() = default;
+};
+
+// Receiver class that performs the actual operations.
+class Light
+{
+private:
+    bool on_ = false;
+
+public:
+    void turnOn() { on_ = true; }
+    void turnOff() { on_ = false; }
+    void set(bool on) { on_ = on; }
+    bool isOn() const { return on_; }
+};
+
+// A group of lights; the history snapshots all of them at once.
+class Room
+{
+public:
+    using Snapshot = std::vector<bool>;
+
+    std::vector<Light> lights;
+
+    explicit Room(std::size_t count) : lights(count) {}
+
+    void save(Snapshot &snapshot) const
+    {
+        snapshot.resize(lights.size());
+        for (std::size_t i = 0; i < lights.size(); ++i)
+        {
+            snapshot[i] = lights[i].isOn();
+        }
+    }
+
+    // Heap memory of one Snapshot. std::vector<bool> packs the bits into whole words.
+    std::size_t snapshotBytes() const
+    {
+        const std::size_t wordBits = CHAR_BIT * sizeof(unsigned long);
+        return (lights.size() + wordBits - 1) / wordBits * sizeof(unsigned long);
+    }
+
+    void restore(const Snapshot &snapshot)
+    {
+        for (std::size_t i = 0; i < lights.size(); ++i)
+        {
+            lights[i].set(snapshot[i]);
+        }
+    }
+
+    std::string describe() const
+    {
+        std::string text;
+        for (const auto &light : lights)
+        {
+            text += light.isOn() ? '1' : '0';
+        }
+        return text;
+    }
+};
+
+// Concrete command for turning on the light. Remembers the previous state for undo.
+class LightOnCommand : public Command
+{
+private:
+    Light &light;
+    bool wasOn = false;
+
+public:
+    LightOnCommand(Light &light) : light(light) {}
+
+    void execute() override
+    {
+        wasOn = light.isOn();
+        light.turnOn();
+    }
+
+    void undo() override
+    {
+        light.set(wasOn);
+    }
+};
+
+// Concrete command for turning off the light. Remembers the previous state for undo.
+class LightOffCommand : public Command
+{
+private:
+    Light &light;
+    bool wasOn = false;
+
+public:
+    LightOffCommand(Light &light) : light(light) {}
+
+    void execute() override
+    {
+        wasOn = light.isOn();
+        light.turnOff();
+    }
+
+    void undo() override
+    {
+        light.set(wasOn);
+    }
+};
+
+// Bounded undo/redo history with periodic snapshots of the Room.
+// Positions are absolute: the command at position p moves the room from state p to state p + 1.
+class CommandHistory
+{
+public:
+    static constexpr std::size_t kSlotSize = 32;
+    static constexpr std::uint64_t kSnapshotInterval = 64;
+
+private:
+    struct alignas(std::max_align_t) Slot
+    {
+        unsigned char bytes[kSlotSize];
+    };
+
+    struct SnapshotEntry
+    {
+        std::uint64_t position = UINT64_MAX; // UINT64_MAX marks an unused entry.
+        Room::Snapshot state;
+    };
+
+    Room &room_;
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t capacity_;
+    std::size_t entryBytes_; // One snapshot entry, including the room state it holds.
+    std::vector<SnapshotEntry> snapshots_;
+    std::uint64_t first_ = 0;  // Oldest position that can still be undone.
+    std::uint64_t cursor_ = 0; // Current position.
+    std::uint64_t end_ = 0;    // One past the last position that can be redone.
+
+    Command *at(std::uint64_t position) const
+    {
+        return std::launder(reinterpret_cast<Command *>(slots_[position % capacity_].bytes));
+    }
+
+    SnapshotEntry &snapshotFor(std::uint64_t position)
+    {
+        return snapshots_[(position / kSnapshotInterval) % snapshots_.size()];
+    }
+
+    // Forget commands that can no longer be redone.
+    void dropRedo()
+    {
+        for (std::uint64_t position = cursor_; position < end_; ++position)
+        {
+            at(position)->~Command();
+        }
+        for (auto &snapshot : snapshots_)
+        {
+            if (snapshot.position != UINT64_MAX && snapshot.position > cursor_)
+            {
+                snapshot.position = UINT64_MAX;
+            }
+        }
+        end_ = cursor_;
+    }
+
+    // Forget the oldest command to make room for a new one.
+    void dropOldest()
+    {
+        at(first_)->~Command();
+        ++first_;
+    }
+
+    // The newest snapshot at or before a position that is still inside the history.
+    const SnapshotEntry *snapshotBefore(std::uint64_t position)
+    {
+        std::uint64_t candidate = position - position % kSnapshotInterval;
+        for (std::size_t i = 0; i < snapshots_.size() && candidate >= first_; ++i)
+        {
+            const SnapshotEntry &snapshot = snapshotFor(candidate);
+            if (snapshot.position == candidate)
+            {
+                return &snapshot;
+            }
+            if (candidate < kSnapshotInterval)
+            {
+                break;
+            }
+            candidate -= kSnapshotInterval;
+        }
+        return nullptr;
+    }
+
+public:
+    // The command slots and the snapshots together never use more than maxBytes.
+    // There is one snapshot per kSnapshotInterval slots, plus two, so each slot is charged
+    // sizeof(Slot) plus its share of a snapshot.
+    CommandHistory(Room &room, std::size_t maxBytes)
+        : room_(room), capacity_(0), entryBytes_(sizeof(SnapshotEntry) + room.snapshotBytes())
+    {
+        if (maxBytes > 2 * entryBytes_)
+        {
+            capacity_ = (maxBytes - 2 * entryBytes_) * kSnapshotInterval / (kSnapshotInterval * sizeof(Slot) + entryBytes_);
+        }
+        if (capacity_ == 0)
+        {
+            throw std::invalid_argument("CommandHistory: maxBytes too small for this room");
+        }
+        slots_.reset(new Slot[capacity_]);
+        snapshots_.resize(capacity_ / kSnapshotInterval + 2);
+        for (auto &snapshot : snapshots_)
+        {
+            snapshot.state.reserve(room.lights.size());
+        }
+    }
+
+    CommandHistory(const CommandHistory &) = delete;
+    CommandHistory &operator=(const CommandHistory &) = delete;
+
+    ~CommandHistory()
+    {
+        for (std::uint64_t position = first_; position < end_; ++position)
+        {
+            at(position)->~Command();
+        }
+    }
+
+    // Construct a command inside the history, execute it and record it.
+    template <typename ConcreteCommand, typename... Args>
+    void execute(Args &&...args)
+    {
+        static_assert(std::is_base_of<Command, ConcreteCommand>::value, "not a Command");
+        static_assert(sizeof(ConcreteCommand) <= kSlotSize, "command does not fit in a history slot");
+        static_assert(alignof(ConcreteCommand) <= alignof(Slot), "command is over-aligned");
+
+        dropRedo();
+        if (cursor_ - first_ == capacity_)
+        {
+            dropOldest();
+        }
+        if (cursor_ % kSnapshotInterval == 0)
+        {
+            SnapshotEntry &snapshot = snapshotFor(cursor_);
+            room_.save(snapshot.state);
+            snapshot.position = cursor_;
+        }
+
+        Command *command = new (slots_[cursor_ % capacity_].bytes) ConcreteCommand(std::forward<Args>(args)...);
+        command->execute();
+        end_ = ++cursor_;
+    }
+
+    bool undo()
+    {
+        if (cursor_ == first_)
+        {
+            return false;
+        }
+        at(--cursor_)->undo();
+        return true;
+    }
+
+    bool redo()
+    {
+        if (cursor_ == end_)
+        {
+            return false;
+        }
+        at(cursor_++)->execute();
+        return true;
+    }
+
+    // Move to any position between oldestPosition() and newestPosition().
+    // Far jumps restore a snapshot and replay fewer than kSnapshotInterval commands.
+    bool jumpTo(std::uint64_t position)
+    {
+        if (position < first_ || position > end_)
+        {
+            return false;
+        }
+        std::uint64_t distance = position < cursor_ ? cursor_ - position : position - cursor_;
+        const SnapshotEntry *snapshot = distance > kSnapshotInterval ? snapshotBefore(position) : nullptr;
+        if (snapshot)
+        {
+            room_.restore(snapshot->state);
+            cursor_ = snapshot->position;
+        }
+        while (cursor_ > position)
+        {
+            undo();
+        }
+        while (cursor_ < position)
+        {
+            redo();
+        }
+        return true;
+    }
+
+    // Memory used by the command slots and the snapshots.
+    std::size_t bytes() const { return capacity_ * sizeof(Slot) + snapshots_.size() * entryBytes_; }
+
+    std::uint64_t position() const { return cursor_; }
+    std::uint64_t oldestPosition() const { return first_; }
+    std::uint64_t newestPosition() const { return end_; }
+};
+
+int main()
+{
+    Room room(4);
+    CommandHistory history(room, 64 * 1024);
+
+    history.execute<LightOnCommand>(room.lights[0]);
+    history.execute<LightOnCommand>(room.lights[1]);
+    history.execute<LightOffCommand>(room.lights[0]);
+    std::cout << "After three commands: " << room.describe() << std::endl; // 0100
+
+    history.undo();
+    std::cout << "After undo:           " << room.describe() << std::endl; // 1100
+    history.undo();
+    std::cout << "After undo:           " << room.describe() << std::endl; // 1000
+    history.redo();
+    std::cout << "After redo:           " << room.describe() << std::endl; // 1100
+
+    // A long random session on a bigger room with the same 64 KB history.
+    Room bigRoom(256);
+    CommandHistory bigHistory(bigRoom, 64 * 1024);
+    std::mt19937 random(42);
+    Room::Snapshot expected;
+    const std::uint64_t commands = 1000000;
+    const std::uint64_t target = commands - 1500;
+    for (std::uint64_t i = 0; i < commands; ++i)
+    {
+        if (i == target)
+        {
+            bigRoom.save(expected);
+        }
+        Light &light = bigRoom.lights[random() % bigRoom.lights.size()];
+        if (random() % 2)
+            bigHistory.execute<LightOnCommand>(light);
+        else
+            bigHistory.execute<LightOffCommand>(light);
+    }
+    bool withinLimit = bigHistory.bytes() <= 64 * 1024;
+    std::cout << "History keeps positions " << bigHistory.oldestPosition() << " to "
+              << bigHistory.newestPosition() << " in " << bigHistory.bytes() << " bytes, snapshots included"
+              << (withinLimit ? "" : " (OVER 64 KB)") << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; ++i)
+    {
+        bigHistory.undo();
+        bigHistory.redo();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "undo + redo: " << static_cast<long>(elapsed.count() / 1000) << " ns" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    bigHistory.jumpTo(target);
+    elapsed = std::chrono::steady_clock::now() - start;
+
+    Room::Snapshot actual;
+    bigRoom.save(actual);
+    std::cout << "Jump back 1500 commands: " << static_cast<long>(elapsed.count()) << " ns, state "
+              << (actual == expected ? "matches" : "DOES NOT match") << std::endl;
+
+    return actual == expected && withinLimit ? 0 : 1;
+}
@@ -0,0 +1,341 @@
+/*
+ * Arena-Allocated Composite Example
+ * -----------------------------------
+ * A composite tree built from std::shared_ptr has two problems at large sizes:
+ * - draw() recurses once per level, so a degenerate tree that is millions of levels deep
+ *   overflows the stack (and so does its recursive destruction).
+ * - Tearing the tree down costs one reference-count decrement and one free per node.
+ *
+ * This version allocates every node from a NodeArena:
+ * - Nodes are placed one after another in large chunks. Children are linked through raw
+ *   sibling pointers, so nodes own no memory and need no destructor.
+ * - Dropping the whole scene frees the chunks, one free per megabyte instead of per node.
+ * - Every traversal is iterative and keeps its own explicit stack; a chain of composites
+ *   does not even use that stack, because only pending siblings are remembered.
+ *
+ * Nodes must not outlive the arena they were created in.
+ */
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <chrono>
+
+// Bump allocator that releases all of its memory at once.
+class NodeArena
+{
+private:
+    static constexpr std::size_t kChunkSize = 1 << 20;
+
+    std::vector<std::unique_ptr<unsigned char[]>> chunks_;
+    unsigned char *next_ = nullptr;
+    std::size_t left_ = 0;
+
+    void *allocate(std::size_t size, std::size_t alignment)
+    {
+        std::size_t padding = (alignment - reinterpret_cast<std::uintptr_t>(next_) % alignment) % alignment;
+        if (!next_ || padding + size > left_)
+        {
+            chunks_.emplace_back(new unsigned char[kChunkSize]);
+            next_ = chunks_.back().get();
+            left_ = kChunkSize;
+            padding = 0;
+        }
+        void *memory = next_ + padding;
+        next_ += padding + size;
+        left_ -= padding + size;
+        return memory;
+    }
+
+public:
+    NodeArena() = default;
+    NodeArena(const NodeArena &) = delete;
+    NodeArena &operator=(const NodeArena &) = delete;
+
+    // Create a node inside the arena. Only types without a destructor are accepted,
+    // because the arena never runs destructors.
+    template <typename Node, typename... Args>
+    Node *make(Args &&...args)
+    {
+        static_assert(std::is_trivially_destructible<Node>::value, "arena nodes must not need a destructor");
+        static_assert(sizeof(Node) <= kChunkSize, "node larger than an arena chunk");
+        return new (allocate(sizeof(Node), alignof(Node))) Node(std::forward<Args>(args)...);
+    }
+
+    // Drop every node at once. Pointers into the arena become invalid.
+    void release()
+    {
+        chunks_.clear();
+        next_ = nullptr;
+        left_ = 0;
+    }
+
+    std::size_t bytesReserved() const
+    {
+        return chunks_.size() * kChunkSize;
+    }
+};
+
+class CompositeGraphic;
+
+// Abstract component. The destructor is protected and non-virtual: nodes are never deleted
+// individually, they disappear with their arena.
+class Graphic
+{
+public:
+    // Output of this node alone; children are handled by the traversal.
+    virtual void drawSelf(std::ostream &out) const = 0;
+
+    // First child, or nullptr for leaves.
+    virtual const Graphic *firstChild() const
+    {
+        return nullptr;
+    }
+
+    const Graphic *nextSibling() const
+    {
+        return nextSibling_;
+    }
+
+    // Visit the subtree in depth-first pre-order without recursion.
+    template <typename Visit>
+    void forEachPreorder(Visit visit) const
+    {
+        std::vector<const Graphic *> pending; // Siblings still to visit, deepest last.
+        const Graphic *node = this;
+        while (node)
+        {
+            visit(*node);
+            const Graphic *child = node->firstChild();
+            const Graphic *sibling = node == this ? nullptr : node->nextSibling_;
+            if (child)
+            {
+                if (sibling)
+                {
+                    pending.push_back(sibling);
+                }
+                node = child;
+            }
+            else if (sibling)
+            {
+                node = sibling;
+            }
+            else if (!pending.empty())
+            {
+                node = pending.back();
+                pending.pop_back();
+            }
+            else
+            {
+                node = nullptr;
+            }
+        }
+    }
+
+    void draw(std::ostream &out) const
+    {
+        forEachPreorder([&](const Graphic &graphic)
+                        { graphic.drawSelf(out); });
+    }
+
+    std::size_t countNodes() const
+    {
+        std::size_t count = 0;
+        forEachPreorder([&](const Graphic &)
+                        { ++count; });
+        return count;
+    }
+
+protected:
+    ~Graphic() = default;
+
+private:
+    friend class CompositeGraphic;
+    const Graphic *nextSibling_ = nullptr;
+};
+
+// Leaf
+class Circle : public Graphic
+{
+public:
+    void drawSelf(std::ostream &out) const override
+    {
+        out << "Drawing Circle\n";
+    }
+};
+
+class Square : public Graphic
+{
+public:
+    void drawSelf(std::ostream &out) const override
+    {
+        out << "Drawing Square\n";
+    }
+};
+
+// Composite. Children form a singly linked list through their sibling pointers.
+class CompositeGraphic : public Graphic
+{
+public:
+    // A graphic belongs to at most one composite, and must come from the same arena.
+    void add(Graphic *graphic)
+    {
+        if (lastChild_)
+            lastChild_->nextSibling_ = graphic;
+        else
+            firstChild_ = graphic;
+        lastChild_ = graphic;
+    }
+
+    void drawSelf(std::ostream &out) const override
+    {
+        out << "CompositeGraphic contains:\n";
+    }
+
+    const Graphic *firstChild() const override
+    {
+        return firstChild_;
+    }
+
+private:
+    Graphic *firstChild_ = nullptr;
+    Graphic *lastChild_ = nullptr;
+};
+
+// The classic shared_ptr tree, for the teardown comparison.
+namespace classic
+{
+    class Graphic
+    {
+    public:
+        virtual ~Graphic() = default;
+    };
+
+    class Circle : public Graphic
+    {
+    };
+
+    class CompositeGraphic : public Graphic
+    {
+    public:
+        void add(const std::shared_ptr<Graphic> &graphic)
+        {
+            graphics_.push_back(graphic);
+        }
+
+    private:
+        std::vector<std::shared_ptr<Graphic>> graphics_;
+    };
+}
+
+// Stream buffer that discards everything, so the timings measure traversal, not output.
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+double millisSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Client
+int main()
+{
+    {
+        NodeArena arena;
+        Circle *circle1 = arena.make<Circle>();
+        Square *square1 = arena.make<Square>();
+        Circle *circle2 = arena.make<Circle>();
+
+        CompositeGraphic *composite = arena.make<CompositeGraphic>();
+        composite->add(circle1);
+        composite->add(square1);
+
+        CompositeGraphic *mainComposite = arena.make<CompositeGraphic>();
+        mainComposite->add(composite);
+        mainComposite->add(circle2);
+
+        mainComposite->draw(std::cout);
+    } // The arena frees every node here.
+
+    NullBuffer nullBuffer;
+    std::ostream nullStream(&nullBuffer);
+
+    // A degenerate chain of 10 million nested composites: recursion would overflow the stack.
+    {
+        const std::size_t depth = 10000000;
+        NodeArena arena;
+        auto start = std::chrono::steady_clock::now();
+        CompositeGraphic *root = arena.make<CompositeGraphic>();
+        CompositeGraphic *parent = root;
+        for (std::size_t i = 1; i < depth; ++i)
+        {
+            CompositeGraphic *child = arena.make<CompositeGraphic>();
+            parent->add(child);
+            parent = child;
+        }
+        parent->add(arena.make<Circle>());
+        double build = millisSince(start);
+
+        start = std::chrono::steady_clock::now();
+        root->draw(nullStream);
+        double draw = millisSince(start);
+
+        std::size_t nodes = root->countNodes();
+        std::size_t megabytes = arena.bytesReserved() >> 20;
+        start = std::chrono::steady_clock::now();
+        arena.release();
+        double drop = millisSince(start);
+
+        std::cout << "Chain of " << nodes << " nodes (" << megabytes << " MB): build " << build
+                  << " ms, draw " << draw << " ms, drop " << drop << " ms" << std::endl;
+    }
+
+    // A wide tree of one million leaves: arena versus shared_ptr teardown.
+    const std::size_t groups = 1000, leavesPerGroup = 1000;
+    {
+        NodeArena arena;
+        auto start = std::chrono::steady_clock::now();
+        CompositeGraphic *root = arena.make<CompositeGraphic>();
+        for (std::size_t g = 0; g < groups; ++g)
+        {
+            CompositeGraphic *group = arena.make<CompositeGraphic>();
+            for (std::size_t l = 0; l < leavesPerGroup; ++l)
+            {
+                group->add(arena.make<Circle>());
+            }
+            root->add(group);
+        }
+        double build = millisSince(start);
+        start = std::chrono::steady_clock::now();
+        arena.release();
+        std::cout << "Arena tree of 1M leaves:      build " << build << " ms, drop " << millisSince(start) << " ms" << std::endl;
+    }
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto root = std::make_shared<classic::CompositeGraphic>();
+        for (std::size_t g = 0; g < groups; ++g)
+        {
+            auto group = std::make_shared<classic::CompositeGraphic>();
+            for (std::size_t l = 0; l < leavesPerGroup; ++l)
+            {
+                group->add(std::make_shared<classic::Circle>());
+            }
+            root->add(group);
+        }
+        double build = millisSince(start);
+        start = std::chrono::steady_clock::now();
+        root.reset();
+        std::cout << "shared_ptr tree of 1M leaves: build " << build << " ms, drop " << millisSince(start) << " ms" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,505 @@
+/*
+ * Memory-Mapped Composite Scene Example
+ * ---------------------------------------
+ * Building a large composite tree node by node at every start-up is slow. This example stores
+ * a whole tree in a compact, versioned binary file that can be used directly after mmap():
+ * - The file is a header followed by one fixed-size record per node in depth-first order.
+ * - Records contain no pointers. A record stores the size of its subtree, so the next sibling
+ *   of the node at index i is at index i + subtreeSize, and its first child is at i + 1.
+ * - SceneWriter streams a live tree to the file. A composite's subtree size is only known
+ *   after its children are written, so it is patched afterwards: in the output buffer if
+ *   the record is still there, otherwise with a positioned write. Counts are 32 bits wide;
+ *   the writer throws rather than write a subtree or child count that does not fit.
+ * - MappedScene maps the file read-only and traverses it in place. Opening it costs a few
+ *   system calls and one sequential pass that checks every record (valid kind, subtrees that
+ *   nest inside their parent, child counts that match), so a damaged file is rejected up
+ *   front instead of sending a traversal out of bounds.
+ *
+ * The example uses POSIX file APIs (open, pwrite, mmap).
+ */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// On-disk layout.
+enum class NodeKind : std::uint32_t
+{
+    Composite = 0,
+    Circle = 1,
+    Square = 2
+};
+
+struct SceneHeader
+{
+    char magic[8] = {'G', 'S', 'C', 'E', 'N', 'E', '\0', '\0'};
+    std::uint32_t version = 1;
+    std::uint32_t recordSize = 12;
+    std::uint64_t nodeCount = 0;
+};
+
+struct SceneRecord
+{
+    NodeKind kind;
+    std::uint32_t childCount;
+    std::uint32_t subtreeSize; // Number of records in the subtree, including this one.
+};
+
+static_assert(sizeof(SceneRecord) == 12, "SceneRecord layout must not change within a version");
+
+class SceneWriter;
+
+// Abstract component
+class Graphic
+{
+public:
+    virtual void draw(std::ostream &out) const = 0;
+    virtual void writeTo(SceneWriter &writer) const = 0;
+    virtual ~Graphic() = default;
+};
+
+// Writes a tree to a scene file through a buffer, patching subtree sizes once they are known.
+class SceneWriter
+{
+private:
+    static constexpr std::size_t kBufferRecords = 1 << 16;
+
+    int fd_;
+    std::vector<SceneRecord> buffer_;
+    std::uint64_t flushedRecords_ = 0; // Records already written to the file.
+
+    static void check(bool ok, const char *what)
+    {
+        if (!ok)
+        {
+            throw std::runtime_error(what);
+        }
+    }
+
+    void flush()
+    {
+        const char *bytes = reinterpret_cast<const char *>(buffer_.data());
+        std::size_t size = buffer_.size() * sizeof(SceneRecord);
+        while (size > 0)
+        {
+            ssize_t written = ::write(fd_, bytes, size);
+            check(written > 0, "scene write failed");
+            bytes += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        flushedRecords_ += buffer_.size();
+        buffer_.clear();
+    }
+
+    static off_t offsetOf(std::uint64_t index)
+    {
+        return static_cast<off_t>(sizeof(SceneHeader) + index * sizeof(SceneRecord));
+    }
+
+public:
+    explicit SceneWriter(const std::string &path)
+    {
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        check(fd_ >= 0, "cannot create scene file");
+        SceneHeader header;
+        check(::write(fd_, &header, sizeof(header)) == sizeof(header), "scene write failed");
+        buffer_.reserve(kBufferRecords);
+    }
+
+    SceneWriter(const SceneWriter &) = delete;
+    SceneWriter &operator=(const SceneWriter &) = delete;
+
+    ~SceneWriter()
+    {
+        ::close(fd_);
+    }
+
+    // Append a record and return its index. A composite's subtree size is filled in by close().
+    // Throws if the count does not fit the 32-bit field of this format version.
+    std::uint64_t open(NodeKind kind, std::uint64_t childCount)
+    {
+        check(childCount <= UINT32_MAX, "too many children for the scene format");
+        if (buffer_.size() == kBufferRecords)
+        {
+            flush();
+        }
+        buffer_.push_back(SceneRecord{kind, static_cast<std::uint32_t>(childCount), 1});
+        return flushedRecords_ + buffer_.size() - 1;
+    }
+
+    // Record that everything written since open(index) belongs to that node's subtree.
+    // Throws if the subtree has more records than the 32-bit field of this format version holds.
+    void close(std::uint64_t index)
+    {
+        std::uint64_t records = flushedRecords_ + buffer_.size() - index;
+        check(records <= UINT32_MAX, "subtree too large for the scene format");
+        auto subtreeSize = static_cast<std::uint32_t>(records);
+        if (index >= flushedRecords_)
+        {
+            buffer_[index - flushedRecords_].subtreeSize = subtreeSize;
+            return;
+        }
+        off_t field = offsetOf(index) + static_cast<off_t>(offsetof(SceneRecord, subtreeSize));
+        check(::pwrite(fd_, &subtreeSize, sizeof(subtreeSize), field) == sizeof(subtreeSize), "scene patch failed");
+    }
+
+    // Write the last records and the final header.
+    void finish()
+    {
+        flush();
+        SceneHeader header;
+        header.nodeCount = flushedRecords_;
+        check(::pwrite(fd_, &header, sizeof(header), 0) == sizeof(header), "scene header write failed");
+    }
+};
+
+// Leaf
+class Circle : public Graphic
+{
+public:
+    void draw(std::ostream &out) const override
+    {
+        out << "Drawing Circle\n";
+    }
+
+    void writeTo(SceneWriter &writer) const override
+    {
+        writer.open(NodeKind::Circle, 0);
+    }
+};
+
+class Square : public Graphic
+{
+public:
+    void draw(std::ostream &out) const override
+    {
+        out << "Drawing Square\n";
+    }
+
+    void writeTo(SceneWriter &writer) const override
+    {
+        writer.open(NodeKind::Square, 0);
+    }
+};
+
+// Composite
+class CompositeGraphic : public Graphic
+{
+public:
+    void add(const std::shared_ptr<Graphic> &graphic)
+    {
+        graphics_.push_back(graphic);
+    }
+
+    void draw(std::ostream &out) const override
+    {
+        out << "CompositeGraphic contains:\n";
+        for (const auto &graphic : graphics_)
+        {
+            graphic->draw(out);
+        }
+    }
+
+    void writeTo(SceneWriter &writer) const override
+    {
+        std::uint64_t index = writer.open(NodeKind::Composite, graphics_.size());
+        for (const auto &graphic : graphics_)
+        {
+            graphic->writeTo(writer);
+        }
+        writer.close(index);
+    }
+
+private:
+    std::vector<std::shared_ptr<Graphic>> graphics_;
+};
+
+// Write a whole tree to a scene file.
+void saveScene(const Graphic &root, const std::string &path)
+{
+    SceneWriter writer(path);
+    root.writeTo(writer);
+    writer.finish();
+}
+
+// Read-only view of a scene file, used in place.
+class MappedScene
+{
+private:
+    void *mapping_ = MAP_FAILED;
+    std::size_t size_ = 0;
+    const SceneRecord *records_ = nullptr;
+    std::uint64_t count_ = 0;
+
+    // Checks that the records form exactly one well-formed tree in depth-first order.
+    bool recordsValid() const
+    {
+        struct Open
+        {
+            std::uint64_t end;       // Index just past the composite's subtree.
+            std::uint64_t remaining; // Children not seen yet.
+        };
+        std::vector<Open> open;
+        for (std::uint64_t i = 0; i < count_; ++i)
+        {
+            const SceneRecord &record = records_[i];
+            std::uint64_t limit = count_;
+            if (i > 0)
+            {
+                if (open.empty() || open.back().remaining == 0)
+                {
+                    return false; // More records than the parent has children.
+                }
+                --open.back().remaining;
+                limit = open.back().end;
+            }
+            bool leaf = record.kind == NodeKind::Circle || record.kind == NodeKind::Square;
+            if (!leaf && record.kind != NodeKind::Composite)
+            {
+                return false;
+            }
+            if (record.subtreeSize == 0 || record.subtreeSize > limit - i ||
+                (i == 0 && record.subtreeSize != count_) ||
+                (leaf && (record.childCount != 0 || record.subtreeSize != 1)))
+            {
+                return false;
+            }
+            open.push_back(Open{i + record.subtreeSize, record.childCount});
+            while (!open.empty() && open.back().end == i + 1)
+            {
+                if (open.back().remaining != 0)
+                {
+                    return false; // Fewer records than the composite has children.
+                }
+                open.pop_back();
+            }
+        }
+        return open.empty();
+    }
+
+public:
+    // A node of the mapped tree, identified by its record index.
+    class Node
+    {
+    private:
+        const MappedScene *scene_;
+        std::uint64_t index_;
+
+        const SceneRecord &record() const { return scene_->records_[index_]; }
+
+    public:
+        Node(const MappedScene *scene, std::uint64_t index) : scene_(scene), index_(index) {}
+
+        NodeKind kind() const { return record().kind; }
+        std::uint32_t childCount() const { return record().childCount; }
+        std::uint64_t subtreeSize() const { return record().subtreeSize; }
+
+        // Calls visit(Node) for every direct child, skipping over their subtrees.
+        template <typename Visit>
+        void forEachChild(Visit visit) const
+        {
+            std::uint64_t child = index_ + 1;
+            for (std::uint32_t i = 0; i < childCount(); ++i)
+            {
+                Node node(scene_, child);
+                visit(node);
+                child += node.subtreeSize();
+            }
+        }
+    };
+
+    explicit MappedScene(const std::string &path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("cannot open scene " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(SceneHeader))
+        {
+            size_ = static_cast<std::size_t>(info.st_size);
+            mapping_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+
+        SceneHeader expected;
+        const auto *header = static_cast<const SceneHeader *>(mapping_);
+        std::size_t recordBytes = size_ - sizeof(SceneHeader);
+        bool valid = mapping_ != MAP_FAILED && std::memcmp(header->magic, expected.magic, sizeof(expected.magic)) == 0 &&
+                     header->version == expected.version && header->recordSize == sizeof(SceneRecord) &&
+                     recordBytes % sizeof(SceneRecord) == 0 && header->nodeCount == recordBytes / sizeof(SceneRecord) &&
+                     header->nodeCount != 0;
+        if (valid)
+        {
+            count_ = header->nodeCount;
+            records_ = reinterpret_cast<const SceneRecord *>(static_cast<const char *>(mapping_) + sizeof(SceneHeader));
+            valid = recordsValid();
+        }
+        if (!valid)
+        {
+            if (mapping_ != MAP_FAILED)
+            {
+                ::munmap(mapping_, size_);
+            }
+            throw std::runtime_error("not a valid scene file: " + path);
+        }
+    }
+
+    MappedScene(const MappedScene &) = delete;
+    MappedScene &operator=(const MappedScene &) = delete;
+
+    ~MappedScene()
+    {
+        ::munmap(mapping_, size_);
+    }
+
+    Node root() const
+    {
+        return Node(this, 0);
+    }
+
+    std::uint64_t nodeCount() const
+    {
+        return count_;
+    }
+
+    // Records are in draw order, so drawing is one sequential pass over the file.
+    // Every kind was checked when the file was opened.
+    void draw(std::ostream &out) const
+    {
+        for (std::uint64_t i = 0; i < count_; ++i)
+        {
+            switch (records_[i].kind)
+            {
+            case NodeKind::Composite:
+                out << "CompositeGraphic contains:\n";
+                break;
+            case NodeKind::Circle:
+                out << "Drawing Circle\n";
+                break;
+            case NodeKind::Square:
+                out << "Drawing Square\n";
+                break;
+            }
+        }
+    }
+};
+
+// A tree with `fanout` children per composite and `depth` levels of composites.
+std::shared_ptr<Graphic> buildTree(int fanout, int depth)
+{
+    auto composite = std::make_shared<CompositeGraphic>();
+    for (int i = 0; i < fanout; ++i)
+    {
+        if (depth > 1)
+            composite->add(buildTree(fanout, depth - 1));
+        else if (i % 2)
+            composite->add(std::make_shared<Square>());
+        else
+            composite->add(std::make_shared<Circle>());
+    }
+    return composite;
+}
+
+double millisSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Client
+int main()
+{
+    const std::string path = "composite-scene.bin";
+
+    std::shared_ptr<Circle> circle1 = std::make_shared<Circle>();
+    std::shared_ptr<Square> square1 = std::make_shared<Square>();
+    std::shared_ptr<Circle> circle2 = std::make_shared<Circle>();
+
+    std::shared_ptr<CompositeGraphic> composite = std::make_shared<CompositeGraphic>();
+    composite->add(circle1);
+    composite->add(square1);
+
+    std::shared_ptr<CompositeGraphic> mainComposite = std::make_shared<CompositeGraphic>();
+    mainComposite->add(composite);
+    mainComposite->add(circle2);
+
+    saveScene(*mainComposite, path);
+    {
+        MappedScene scene(path);
+        scene.draw(std::cout);
+    }
+
+    // Damaged records must be rejected when the file is opened.
+    auto rejects = [&](std::uint64_t index, std::size_t field, std::uint32_t value)
+    {
+        saveScene(*mainComposite, path);
+        int fd = ::open(path.c_str(), O_WRONLY);
+        off_t offset = static_cast<off_t>(sizeof(SceneHeader) + index * sizeof(SceneRecord) + field);
+        bool written = fd >= 0 && ::pwrite(fd, &value, sizeof(value), offset) == sizeof(value);
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+        try
+        {
+            MappedScene damaged(path);
+            return false;
+        }
+        catch (const std::runtime_error &)
+        {
+            return written;
+        }
+    };
+    bool damageRejected = rejects(1, offsetof(SceneRecord, subtreeSize), 1000000) &&
+                          rejects(2, offsetof(SceneRecord, kind), 7) &&
+                          rejects(0, offsetof(SceneRecord, childCount), 5) &&
+                          rejects(3, offsetof(SceneRecord, childCount), 2);
+    std::cout << "Damaged scene files " << (damageRejected ? "rejected" : "NOT rejected") << std::endl;
+
+    // Start-up cost for a scene of about eight million nodes.
+    auto start = std::chrono::steady_clock::now();
+    auto tree = buildTree(14, 6);
+    double build = millisSince(start);
+
+    start = std::chrono::steady_clock::now();
+    saveScene(*tree, path);
+    double save = millisSince(start);
+
+    start = std::chrono::steady_clock::now();
+    MappedScene scene(path);
+    double open = millisSince(start);
+
+    std::size_t covered = 0; // Nodes below the root, composites included.
+    start = std::chrono::steady_clock::now();
+    scene.root().forEachChild([&](const MappedScene::Node &child)
+                              { covered += child.subtreeSize(); });
+    double walk = millisSince(start);
+
+    std::ostringstream fromTree, fromFile;
+    tree->draw(fromTree);
+    scene.draw(fromFile);
+
+    std::cout << "Scene of " << scene.nodeCount() << " nodes: build from scratch " << build << " ms, save "
+              << save << " ms, open mapped " << open << " ms" << std::endl;
+    std::cout << "Root has " << scene.root().childCount() << " children covering " << covered << " nodes ("
+              << walk << " ms)" << std::endl;
+    std::cout << "Mapped draw " << (fromTree.str() == fromFile.str() ? "matches" : "DOES NOT match")
+              << " the live tree" << std::endl;
+
+    bool ok = fromTree.str() == fromFile.str() && damageRejected;
+    std::remove(path.c_str());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,326 @@
+/*
+ * Composite with Bounding Volumes Example
+ * -----------------------------------------
+ * When leaves have no geometry, answering "what is inside this region?" means visiting every
+ * leaf. Here every Graphic has an axis-aligned bounding box:
+ * - A leaf's box comes from its position and size.
+ * - A composite's box is the union of its children's boxes, so the composite tree doubles
+ *   as a bounding-volume hierarchy.
+ * - Adding a child grows the boxes up the tree; moving a leaf recomputes its parent's box and
+ *   continues upwards only while the box actually changes.
+ * - drawCulled() and query() skip every subtree whose box misses the viewport.
+ *
+ * Culling works best when composites group graphics that are close to each other.
+ */
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <chrono>
+
+// Axis-aligned bounding box. An empty box has min > max.
+struct Bounds
+{
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+
+    static Bounds of(float minX, float minY, float maxX, float maxY)
+    {
+        Bounds bounds;
+        bounds.minX = minX;
+        bounds.minY = minY;
+        bounds.maxX = maxX;
+        bounds.maxY = maxY;
+        return bounds;
+    }
+
+    bool intersects(const Bounds &other) const
+    {
+        return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+    }
+
+    void expand(const Bounds &other)
+    {
+        minX = std::min(minX, other.minX);
+        minY = std::min(minY, other.minY);
+        maxX = std::max(maxX, other.maxX);
+        maxY = std::max(maxY, other.maxY);
+    }
+
+    bool operator==(const Bounds &other) const
+    {
+        return minX == other.minX && minY == other.minY && maxX == other.maxX && maxY == other.maxY;
+    }
+};
+
+class CompositeGraphic;
+
+// Abstract component
+class Graphic
+{
+public:
+    virtual void draw(std::ostream &out) const = 0;
+    // Draw only the parts that intersect the viewport.
+    virtual void drawCulled(const Bounds &viewport, std::ostream &out) const = 0;
+    // Collect the leaves that intersect the region.
+    virtual void query(const Bounds &region, std::vector<const Graphic *> &hits) const = 0;
+    virtual ~Graphic() = default;
+
+    const Bounds &bounds() const
+    {
+        return bounds_;
+    }
+
+protected:
+    // Store new bounds and let the parent adjust its own.
+    void setBounds(const Bounds &bounds);
+
+    Bounds bounds_;
+
+private:
+    friend class CompositeGraphic;
+    CompositeGraphic *parent_ = nullptr;
+};
+
+// Base for leaves: culling and queries only need the box.
+class Leaf : public Graphic
+{
+public:
+    void drawCulled(const Bounds &viewport, std::ostream &out) const override
+    {
+        if (bounds_.intersects(viewport))
+        {
+            draw(out);
+        }
+    }
+
+    void query(const Bounds &region, std::vector<const Graphic *> &hits) const override
+    {
+        if (bounds_.intersects(region))
+        {
+            hits.push_back(this);
+        }
+    }
+};
+
+// Leaf
+class Circle : public Leaf
+{
+public:
+    Circle(float x, float y, float radius) : radius_(radius)
+    {
+        moveTo(x, y);
+    }
+
+    void moveTo(float x, float y)
+    {
+        x_ = x;
+        y_ = y;
+        setBounds(Bounds::of(x - radius_, y - radius_, x + radius_, y + radius_));
+    }
+
+    void draw(std::ostream &out) const override
+    {
+        out << "Drawing Circle at (" << x_ << ", " << y_ << ")\n";
+    }
+
+private:
+    float x_ = 0, y_ = 0, radius_;
+};
+
+class Square : public Leaf
+{
+public:
+    Square(float x, float y, float side) : side_(side)
+    {
+        moveTo(x, y);
+    }
+
+    // (x, y) is the lower-left corner.
+    void moveTo(float x, float y)
+    {
+        x_ = x;
+        y_ = y;
+        setBounds(Bounds::of(x, y, x + side_, y + side_));
+    }
+
+    void draw(std::ostream &out) const override
+    {
+        out << "Drawing Square at (" << x_ << ", " << y_ << ")\n";
+    }
+
+private:
+    float x_ = 0, y_ = 0, side_;
+};
+
+// Composite
+class CompositeGraphic : public Graphic
+{
+public:
+    // A graphic belongs to at most one composite.
+    void add(const std::shared_ptr<Graphic> &graphic)
+    {
+        graphic->parent_ = this;
+        graphics_.push_back(graphic);
+        Bounds grown = bounds_;
+        grown.expand(graphic->bounds());
+        setBounds(grown);
+    }
+
+    void draw(std::ostream &out) const override
+    {
+        out << "CompositeGraphic contains:\n";
+        for (const auto &graphic : graphics_)
+        {
+            graphic->draw(out);
+        }
+    }
+
+    void drawCulled(const Bounds &viewport, std::ostream &out) const override
+    {
+        if (!bounds_.intersects(viewport))
+        {
+            return;
+        }
+        out << "CompositeGraphic contains:\n";
+        for (const auto &graphic : graphics_)
+        {
+            graphic->drawCulled(viewport, out);
+        }
+    }
+
+    void query(const Bounds &region, std::vector<const Graphic *> &hits) const override
+    {
+        if (!bounds_.intersects(region))
+        {
+            return;
+        }
+        for (const auto &graphic : graphics_)
+        {
+            graphic->query(region, hits);
+        }
+    }
+
+    // A child's box changed: recompute ours from all children.
+    void childMoved()
+    {
+        Bounds united;
+        for (const auto &graphic : graphics_)
+        {
+            united.expand(graphic->bounds());
+        }
+        setBounds(united);
+    }
+
+private:
+    std::vector<std::shared_ptr<Graphic>> graphics_;
+};
+
+void Graphic::setBounds(const Bounds &bounds)
+{
+    if (bounds == bounds_)
+    {
+        return;
+    }
+    bounds_ = bounds;
+    if (parent_)
+    {
+        parent_->childMoved();
+    }
+}
+
+// A scene of `count` leaves spread over a square world, grouped by recursively splitting
+// the world into quadrants until a region holds at most `perGroup` leaves.
+std::shared_ptr<CompositeGraphic> buildRegion(float x, float y, float size, std::size_t count, std::size_t perGroup,
+                                              std::mt19937 &random, std::vector<Graphic *> &leaves)
+{
+    auto composite = std::make_shared<CompositeGraphic>();
+    if (count <= perGroup)
+    {
+        std::uniform_real_distribution<float> offset(0.0f, size);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            std::shared_ptr<Graphic> leaf;
+            if (i % 2)
+                leaf = std::make_shared<Square>(x + offset(random), y + offset(random), 0.5f);
+            else
+                leaf = std::make_shared<Circle>(x + offset(random), y + offset(random), 0.5f);
+            leaves.push_back(leaf.get());
+            composite->add(leaf);
+        }
+        return composite;
+    }
+    float half = size / 2;
+    for (int quadrant = 0; quadrant < 4; ++quadrant)
+    {
+        std::size_t share = count / 4 + (static_cast<std::size_t>(quadrant) < count % 4 ? 1 : 0);
+        composite->add(buildRegion(x + (quadrant % 2) * half, y + (quadrant / 2) * half, half, share, perGroup, random, leaves));
+    }
+    return composite;
+}
+
+// Client
+int main()
+{
+    std::shared_ptr<Circle> circle1 = std::make_shared<Circle>(1, 1, 1);
+    std::shared_ptr<Square> square1 = std::make_shared<Square>(5, 5, 2);
+    std::shared_ptr<Circle> circle2 = std::make_shared<Circle>(20, 20, 1);
+
+    std::shared_ptr<CompositeGraphic> composite = std::make_shared<CompositeGraphic>();
+    composite->add(circle1);
+    composite->add(square1);
+
+    std::shared_ptr<CompositeGraphic> mainComposite = std::make_shared<CompositeGraphic>();
+    mainComposite->add(composite);
+    mainComposite->add(circle2);
+
+    Bounds viewport = Bounds::of(0, 0, 10, 10);
+    std::cout << "Viewport (0, 0)-(10, 10):" << std::endl;
+    mainComposite->drawCulled(viewport, std::cout);
+
+    // Moving a leaf updates the boxes above it.
+    circle2->moveTo(8, 8);
+    std::cout << "After moving circle2 into the viewport:" << std::endl;
+    mainComposite->drawCulled(viewport, std::cout);
+
+    // Query latency against scene size, compared with testing every leaf.
+    std::cout << "Query of a 10 x 10 region in a 1000 x 1000 world:" << std::endl;
+    Bounds region = Bounds::of(495, 495, 505, 505);
+    bool allMatch = true;
+    for (std::size_t count : {10000u, 100000u, 1000000u})
+    {
+        std::mt19937 random(5);
+        std::vector<Graphic *> leaves;
+        auto scene = buildRegion(0, 0, 1000, count, 16, random, leaves);
+
+        const int queries = 100;
+        std::vector<const Graphic *> hits;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < queries; ++i)
+        {
+            hits.clear();
+            scene->query(region, hits);
+        }
+        std::chrono::duration<double, std::micro> culled = std::chrono::steady_clock::now() - start;
+
+        std::size_t bruteHits = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < queries; ++i)
+        {
+            bruteHits = 0;
+            for (const Graphic *leaf : leaves)
+            {
+                bruteHits += leaf->bounds().intersects(region) ? 1 : 0;
+            }
+        }
+        std::chrono::duration<double, std::micro> brute = std::chrono::steady_clock::now() - start;
+
+        std::cout << "  " << count << " leaves: " << culled.count() / queries << " us with culling, "
+                  << brute.count() / queries << " us testing every leaf (" << hits.size() << " hits"
+                  << (hits.size() == bruteHits ? "" : ", MISMATCH") << ")" << std::endl;
+        allMatch = allMatch && hits.size() == bruteHits;
+    }
+
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,273 @@
+/*
+ * Flattened Composite Example
+ * -----------------------------
+ * A composite tree of shared_ptr nodes is convenient to build, but drawing it means a
+ * pointer dereference, a likely cache miss and a virtual call for every node.
+ *
+ * FlatScene converts a finished tree into contiguous arrays:
+ * - Leaves are copied into one array per type (all Circles together, all Squares together).
+ * - The structure is a single array of nodes in depth-first order. Each node records its
+ *   type, its index in the array of that type, its parent and where its subtree ends.
+ * - draw() is therefore one linear scan with a switch on the node type, and it produces
+ *   exactly the same output as drawing the original tree.
+ *
+ * The flattened scene is a read-only snapshot; rebuild it when the tree changes.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <chrono>
+
+class FlatScene;
+
+// Abstract component
+class Graphic
+{
+public:
+    virtual void draw(std::ostream &out) const = 0;
+    // Append this node (and its subtree) to a flattened scene.
+    virtual void flattenInto(FlatScene &scene, std::uint32_t parent) const = 0;
+    virtual ~Graphic() = default;
+};
+
+// Leaf
+class Circle : public Graphic
+{
+public:
+    void draw(std::ostream &out) const override
+    {
+        out << "Drawing Circle\n";
+    }
+
+    void flattenInto(FlatScene &scene, std::uint32_t parent) const override;
+};
+
+class Square : public Graphic
+{
+public:
+    void draw(std::ostream &out) const override
+    {
+        out << "Drawing Square\n";
+    }
+
+    void flattenInto(FlatScene &scene, std::uint32_t parent) const override;
+};
+
+// Composite
+class CompositeGraphic : public Graphic
+{
+public:
+    void add(const std::shared_ptr<Graphic> &graphic)
+    {
+        graphics_.push_back(graphic);
+    }
+
+    void draw(std::ostream &out) const override
+    {
+        out << "CompositeGraphic contains:\n";
+        for (const auto &graphic : graphics_)
+        {
+            graphic->draw(out);
+        }
+    }
+
+    void flattenInto(FlatScene &scene, std::uint32_t parent) const override;
+
+private:
+    std::vector<std::shared_ptr<Graphic>> graphics_;
+};
+
+// Contiguous, type-partitioned copy of a composite tree.
+class FlatScene
+{
+public:
+    enum class Kind : std::uint8_t
+    {
+        Composite,
+        Circle,
+        Square
+    };
+
+    struct Node
+    {
+        Kind kind;
+        std::uint32_t index;      // Position in the array of its kind.
+        std::uint32_t parent;     // kNoParent for the root.
+        std::uint32_t subtreeEnd; // The subtree occupies nodes [own position, subtreeEnd).
+    };
+
+    static constexpr std::uint32_t kNoParent = UINT32_MAX;
+
+    explicit FlatScene(const Graphic &root)
+    {
+        root.flattenInto(*this, kNoParent);
+    }
+
+    // Called by Graphic::flattenInto. Returns the position of the new node.
+    std::uint32_t addNode(Kind kind, std::uint32_t parent)
+    {
+        std::uint32_t index = 0;
+        switch (kind)
+        {
+        case Kind::Composite:
+            index = compositeCount_++;
+            break;
+        case Kind::Circle:
+            index = static_cast<std::uint32_t>(circles_.size());
+            circles_.emplace_back();
+            break;
+        case Kind::Square:
+            index = static_cast<std::uint32_t>(squares_.size());
+            squares_.emplace_back();
+            break;
+        }
+        auto position = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.push_back(Node{kind, index, parent, position + 1});
+        return position;
+    }
+
+    // Called once all children of a composite have been added.
+    void closeSubtree(std::uint32_t position)
+    {
+        nodes_[position].subtreeEnd = static_cast<std::uint32_t>(nodes_.size());
+    }
+
+    // Same output as Graphic::draw on the original tree, in a single pass.
+    // Leaf draw calls are qualified, so the compiler calls them directly.
+    void draw(std::ostream &out) const
+    {
+        for (const Node &node : nodes_)
+        {
+            switch (node.kind)
+            {
+            case Kind::Composite:
+                out << "CompositeGraphic contains:\n";
+                break;
+            case Kind::Circle:
+                circles_[node.index].Circle::draw(out);
+                break;
+            case Kind::Square:
+                squares_[node.index].Square::draw(out);
+                break;
+            }
+        }
+    }
+
+    // Direct children of the node at a position, found by skipping over subtrees.
+    std::vector<std::uint32_t> children(std::uint32_t position) const
+    {
+        std::vector<std::uint32_t> result;
+        for (std::uint32_t child = position + 1; child < nodes_[position].subtreeEnd; child = nodes_[child].subtreeEnd)
+        {
+            result.push_back(child);
+        }
+        return result;
+    }
+
+    const std::vector<Node> &nodes() const { return nodes_; }
+    const std::vector<Circle> &circles() const { return circles_; }
+    const std::vector<Square> &squares() const { return squares_; }
+
+private:
+    std::vector<Node> nodes_;
+    std::vector<Circle> circles_;
+    std::vector<Square> squares_;
+    std::uint32_t compositeCount_ = 0;
+};
+
+void Circle::flattenInto(FlatScene &scene, std::uint32_t parent) const
+{
+    scene.addNode(FlatScene::Kind::Circle, parent);
+}
+
+void Square::flattenInto(FlatScene &scene, std::uint32_t parent) const
+{
+    scene.addNode(FlatScene::Kind::Square, parent);
+}
+
+void CompositeGraphic::flattenInto(FlatScene &scene, std::uint32_t parent) const
+{
+    std::uint32_t position = scene.addNode(FlatScene::Kind::Composite, parent);
+    for (const auto &graphic : graphics_)
+    {
+        graphic->flattenInto(scene, position);
+    }
+    scene.closeSubtree(position);
+}
+
+// Stream buffer that discards everything, so the benchmark measures traversal, not output.
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+// A tree with `fanout` children per composite and `depth` levels of composites.
+std::shared_ptr<Graphic> buildTree(int fanout, int depth)
+{
+    auto composite = std::make_shared<CompositeGraphic>();
+    for (int i = 0; i < fanout; ++i)
+    {
+        if (depth > 1)
+            composite->add(buildTree(fanout, depth - 1));
+        else if (i % 2)
+            composite->add(std::make_shared<Square>());
+        else
+            composite->add(std::make_shared<Circle>());
+    }
+    return composite;
+}
+
+template <typename Draw>
+double millis(Draw draw)
+{
+    auto start = std::chrono::steady_clock::now();
+    draw();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Client
+int main()
+{
+    std::shared_ptr<Circle> circle1 = std::make_shared<Circle>();
+    std::shared_ptr<Square> square1 = std::make_shared<Square>();
+    std::shared_ptr<Circle> circle2 = std::make_shared<Circle>();
+
+    std::shared_ptr<CompositeGraphic> composite = std::make_shared<CompositeGraphic>();
+    composite->add(circle1);
+    composite->add(square1);
+
+    std::shared_ptr<CompositeGraphic> mainComposite = std::make_shared<CompositeGraphic>();
+    mainComposite->add(composite);
+    mainComposite->add(circle2);
+
+    FlatScene scene(*mainComposite);
+    scene.draw(std::cout);
+
+    // Benchmark: a tree with about three million leaves.
+    NullBuffer nullBuffer;
+    std::ostream nullStream(&nullBuffer);
+    auto tree = buildTree(12, 6);
+    FlatScene flat(*tree);
+
+    std::ostringstream fromTree, fromFlat;
+    buildTree(4, 3)->draw(fromTree);
+    FlatScene(*buildTree(4, 3)).draw(fromFlat);
+
+    std::cout << "Nodes: " << flat.nodes().size() << " (" << flat.circles().size() << " circles, "
+              << flat.squares().size() << " squares)" << std::endl;
+    std::cout << "Pointer tree draw: " << millis([&]()
+                                                 { tree->draw(nullStream); })
+              << " ms" << std::endl;
+    std::cout << "Flattened draw:    " << millis([&]()
+                                                 { flat.draw(nullStream); })
+              << " ms" << std::endl;
+    bool same = fromTree.str() == fromFlat.str();
+    std::cout << "Same output: " << (same ? "yes" : "no") << std::endl;
+
+    return same ? 0 : 1;
+}
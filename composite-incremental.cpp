@@ -0,0 +1,273 @@
+/*
+ * Incremental Composite Redraw Example
+ * --------------------------------------
+ * Drawing a composite tree normally re-renders every node, even if only one leaf changed.
+ *
+ * Here every node caches its rendered output:
+ * - Changing a leaf marks the leaf and its ancestors dirty. The walk up stops at the first
+ *   ancestor that is already dirty, so marking costs at most the depth of the tree.
+ * - render() recomputes only dirty nodes. A dirty composite rebuilds its output from the
+ *   cached output of its children, so clean subtrees are reused without being visited.
+ *
+ * When about 1% of the leaves change between frames, only those leaves and the composites
+ * on their paths to the root are rendered again. The price is memory: every composite keeps
+ * a copy of its subtree's output.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <random>
+#include <chrono>
+
+class CompositeGraphic;
+
+// Abstract component with a cached rendering.
+class Graphic
+{
+public:
+    virtual ~Graphic() = default;
+
+    // Rendered output of this subtree, recomputed only if something in it changed.
+    const std::string &render()
+    {
+        if (dirty_)
+        {
+            cache_.clear();
+            renderInto(cache_);
+            dirty_ = false;
+            ++renders;
+        }
+        return cache_;
+    }
+
+    void draw(std::ostream &out)
+    {
+        out << render();
+    }
+
+    // Number of nodes rendered since the counter was last reset.
+    static long renders;
+
+protected:
+    // Produce this node's output from scratch (children may still use their caches).
+    virtual void renderInto(std::string &out) = 0;
+
+    // Called by a node whose own state changed.
+    void markDirty();
+
+private:
+    friend class CompositeGraphic;
+
+    CompositeGraphic *parent_ = nullptr;
+    std::string cache_;
+    bool dirty_ = true;
+};
+
+long Graphic::renders = 0;
+
+// Leaf
+class Circle : public Graphic
+{
+public:
+    explicit Circle(double radius = 1.0) : radius_(radius) {}
+
+    void setRadius(double radius)
+    {
+        radius_ = radius;
+        markDirty();
+    }
+
+protected:
+    void renderInto(std::string &out) override
+    {
+        std::ostringstream text;
+        text << "Drawing Circle with radius " << radius_ << "\n";
+        out += text.str();
+    }
+
+private:
+    double radius_;
+};
+
+class Square : public Graphic
+{
+public:
+    explicit Square(double side = 1.0) : side_(side) {}
+
+    void setSide(double side)
+    {
+        side_ = side;
+        markDirty();
+    }
+
+protected:
+    void renderInto(std::string &out) override
+    {
+        std::ostringstream text;
+        text << "Drawing Square with side " << side_ << "\n";
+        out += text.str();
+    }
+
+private:
+    double side_;
+};
+
+// Composite
+class CompositeGraphic : public Graphic
+{
+public:
+    // A graphic belongs to at most one composite.
+    void add(const std::shared_ptr<Graphic> &graphic)
+    {
+        graphic->parent_ = this;
+        graphics_.push_back(graphic);
+        markDirty();
+    }
+
+    // Forget every cached rendering in this subtree. The ancestors are marked dirty too, so
+    // that the next render() from the root reaches this subtree.
+    void invalidateAll()
+    {
+        markDirty();
+        for (const auto &graphic : graphics_)
+        {
+            graphic->dirty_ = true; // This composite is already dirty, so no walk up is needed.
+            if (auto composite = dynamic_cast<CompositeGraphic *>(graphic.get()))
+            {
+                composite->invalidateAll();
+            }
+        }
+    }
+
+protected:
+    void renderInto(std::string &out) override
+    {
+        out += "CompositeGraphic contains:\n";
+        for (const auto &graphic : graphics_)
+        {
+            out += graphic->render();
+        }
+    }
+
+private:
+    std::vector<std::shared_ptr<Graphic>> graphics_;
+};
+
+void Graphic::markDirty()
+{
+    for (Graphic *node = this; node; node = node->parent_)
+    {
+        if (node->dirty_ && node != this)
+        {
+            break;
+        }
+        node->dirty_ = true;
+    }
+}
+
+// Builds a tree and collects its leaves so they can be modified later.
+std::shared_ptr<CompositeGraphic> buildTree(int fanout, int depth, std::vector<Circle *> &circles, std::vector<Square *> &squares)
+{
+    auto composite = std::make_shared<CompositeGraphic>();
+    for (int i = 0; i < fanout; ++i)
+    {
+        if (depth > 1)
+        {
+            composite->add(buildTree(fanout, depth - 1, circles, squares));
+        }
+        else if (i % 2)
+        {
+            auto square = std::make_shared<Square>(1.0 + i);
+            squares.push_back(square.get());
+            composite->add(square);
+        }
+        else
+        {
+            auto circle = std::make_shared<Circle>(1.0 + i);
+            circles.push_back(circle.get());
+            composite->add(circle);
+        }
+    }
+    return composite;
+}
+
+// Client
+int main()
+{
+    std::shared_ptr<Circle> circle1 = std::make_shared<Circle>();
+    std::shared_ptr<Square> square1 = std::make_shared<Square>();
+    std::shared_ptr<Circle> circle2 = std::make_shared<Circle>();
+
+    std::shared_ptr<CompositeGraphic> composite = std::make_shared<CompositeGraphic>();
+    composite->add(circle1);
+    composite->add(square1);
+
+    std::shared_ptr<CompositeGraphic> mainComposite = std::make_shared<CompositeGraphic>();
+    mainComposite->add(composite);
+    mainComposite->add(circle2);
+
+    mainComposite->draw(std::cout);
+
+    // Only circle2 and mainComposite are rendered again; the inner composite is reused.
+    Graphic::renders = 0;
+    circle2->setRadius(2.5);
+    mainComposite->draw(std::cout);
+    std::cout << "Nodes rendered for this redraw: " << Graphic::renders << std::endl;
+
+    // Invalidating an inner subtree also dirties its ancestors, so drawing the root re-renders
+    // mainComposite, composite, circle1 and square1.
+    Graphic::renders = 0;
+    composite->invalidateAll();
+    mainComposite->render();
+    bool innerRedrawn = Graphic::renders == 4;
+    std::cout << "Nodes rendered after invalidating the inner composite: " << Graphic::renders << std::endl;
+
+    // Frames on a tree with 10000 leaves, changing 1% of them per frame.
+    std::vector<Circle *> circles;
+    std::vector<Square *> squares;
+    auto scene = buildTree(10, 4, circles, squares);
+    scene->render();
+
+    std::mt19937 random(1);
+    const int frames = 50;
+    const std::size_t changesPerFrame = (circles.size() + squares.size()) / 100;
+
+    double fullTime = 0, incrementalTime = 0;
+    long fullRenders = 0, incrementalRenders = 0;
+    bool same = true;
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        for (std::size_t i = 0; i < changesPerFrame; ++i)
+        {
+            double size = 1.0 + random() % 100;
+            if (i % 2)
+                squares[random() % squares.size()]->setSide(size);
+            else
+                circles[random() % circles.size()]->setRadius(size);
+        }
+
+        Graphic::renders = 0;
+        auto start = std::chrono::steady_clock::now();
+        std::string incremental = scene->render();
+        incrementalTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        incrementalRenders += Graphic::renders;
+
+        Graphic::renders = 0;
+        start = std::chrono::steady_clock::now();
+        scene->invalidateAll();
+        std::string full = scene->render();
+        fullTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        fullRenders += Graphic::renders;
+
+        same = same && incremental == full;
+    }
+
+    std::cout << "Per frame: full redraw " << fullRenders / frames << " nodes, " << fullTime / frames << " ms; "
+              << "incremental " << incrementalRenders / frames << " nodes, " << incrementalTime / frames << " ms" << std::endl;
+    std::cout << "Incremental output " << (same ? "matches" : "DOES NOT match") << " full redraw" << std::endl;
+
+    return same && innerRedrawn ? 0 : 1;
+}
@@ -0,0 +1,341 @@
+/*
+ * Parallel Composite Traversal Example
+ * --------------------------------------
+ * CompositeGraphic::draw() visits one child after another on a single thread. For wide and
+ * deep trees the subtrees are independent, so they can be drawn in parallel.
+ *
+ * drawParallel() splits the tree into tasks on a work-stealing thread pool:
+ * - Each worker owns a deque of tasks. It pushes and pops at the back of its own deque, and
+ *   idle workers steal from the front of other workers' deques, so large subtrees spread out.
+ * - A composite whose subtree is large enough spawns one task per composite child; smaller
+ *   subtrees are drawn serially inside the task.
+ * - Every task writes into its own output segment. The segments form a tree that mirrors
+ *   the spawned tasks and are joined in depth-first order at the end, so the result is
+ *   identical to the serial draw().
+ */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <string>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+
+// Abstract component
+class Graphic
+{
+public:
+    virtual void draw(std::ostream &out) const = 0;
+    // Number of nodes in the subtree, used to decide whether it is worth a task.
+    virtual std::size_t size() const { return 1; }
+    virtual ~Graphic() = default;
+};
+
+// Leaf
+class Circle : public Graphic
+{
+public:
+    void draw(std::ostream &out) const override
+    {
+        out << "Drawing Circle\n";
+    }
+};
+
+class Square : public Graphic
+{
+public:
+    void draw(std::ostream &out) const override
+    {
+        out << "Drawing Square\n";
+    }
+};
+
+// Composite
+class CompositeGraphic : public Graphic
+{
+public:
+    void add(const std::shared_ptr<Graphic> &graphic)
+    {
+        graphics_.push_back(graphic);
+        size_ += graphic->size();
+    }
+
+    void draw(std::ostream &out) const override
+    {
+        out << "CompositeGraphic contains:\n";
+        for (const auto &graphic : graphics_)
+        {
+            graphic->draw(out);
+        }
+    }
+
+    // Counted when children are added; a child must be complete before it is added.
+    std::size_t size() const override
+    {
+        return size_;
+    }
+
+    const std::vector<std::shared_ptr<Graphic>> &children() const
+    {
+        return graphics_;
+    }
+
+private:
+    std::vector<std::shared_ptr<Graphic>> graphics_;
+    std::size_t size_ = 1;
+};
+
+// Fixed pool of workers with one task deque each.
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<long> pending_{0};
+    std::atomic<bool> stopping_{false};
+    static thread_local int currentWorker_;
+
+    bool popLocal(std::size_t index, Task &task)
+    {
+        Worker &worker = *workers_[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty())
+        {
+            return false;
+        }
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(std::size_t thief, Task &task)
+    {
+        for (std::size_t i = 1; i < workers_.size(); ++i)
+        {
+            Worker &victim = *workers_[(thief + i) % workers_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Run one task if any is available. Returns false when there was nothing to do.
+    bool runOne(std::size_t index)
+    {
+        Task task;
+        if (popLocal(index, task) || steal(index, task))
+        {
+            task();
+            pending_.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(std::size_t index)
+    {
+        currentWorker_ = static_cast<int>(index);
+        while (!stopping_.load())
+        {
+            if (!runOne(index))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+public:
+    // The calling thread takes part as worker 0, so a pool of n threads starts n - 1 new ones.
+    explicit WorkStealingPool(unsigned threads)
+    {
+        threads = std::max(1u, threads);
+        for (unsigned i = 0; i < threads; ++i)
+        {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        for (unsigned i = 1; i < threads; ++i)
+        {
+            threads_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+        }
+    }
+
+    ~WorkStealingPool()
+    {
+        stopping_ = true;
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    // Queue a task on the current worker's deque.
+    void spawn(Task task)
+    {
+        pending_.fetch_add(1);
+        std::size_t index = currentWorker_ < 0 ? 0 : static_cast<std::size_t>(currentWorker_);
+        Worker &worker = *workers_[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+
+    // Run tasks on the calling thread until every spawned task has finished.
+    void wait()
+    {
+        int previous = currentWorker_;
+        currentWorker_ = 0;
+        while (pending_.load() > 0)
+        {
+            if (!runOne(0))
+            {
+                std::this_thread::yield();
+            }
+        }
+        currentWorker_ = previous;
+    }
+};
+
+thread_local int WorkStealingPool::currentWorker_ = -1;
+
+// Output of one task. Text written before each child segment and after the last one
+// is kept in `text`; children are spliced in at the recorded offsets.
+struct Segment
+{
+    std::string text;
+    std::vector<std::pair<std::size_t, std::unique_ptr<Segment>>> children;
+
+    void appendTo(std::string &out) const
+    {
+        std::size_t written = 0;
+        for (const auto &child : children)
+        {
+            out.append(text, written, child.first - written);
+            child.second->appendTo(out);
+            written = child.first;
+        }
+        out.append(text, written, std::string::npos);
+    }
+};
+
+// Draw a subtree into a segment, spawning tasks for large composite children.
+void drawTask(const Graphic &graphic, Segment &segment, WorkStealingPool &pool, std::size_t grain)
+{
+    auto composite = dynamic_cast<const CompositeGraphic *>(&graphic);
+    if (!composite || composite->size() <= grain)
+    {
+        std::ostringstream out;
+        graphic.draw(out);
+        segment.text = out.str();
+        return;
+    }
+
+    std::ostringstream out;
+    out << "CompositeGraphic contains:\n";
+    for (const auto &child : composite->children())
+    {
+        if (child->size() > 1)
+        {
+            segment.children.emplace_back(static_cast<std::size_t>(out.tellp()), std::make_unique<Segment>());
+            Segment *childSegment = segment.children.back().second.get();
+            const Graphic *childGraphic = child.get();
+            pool.spawn([childGraphic, childSegment, &pool, grain]()
+                       { drawTask(*childGraphic, *childSegment, pool, grain); });
+        }
+        else
+        {
+            child->draw(out);
+        }
+    }
+    segment.text = out.str();
+}
+
+// Parallel equivalent of root.draw(out).
+void drawParallel(const Graphic &root, std::ostream &out, unsigned threads, std::size_t grain = 4096)
+{
+    Segment segment;
+    {
+        WorkStealingPool pool(threads);
+        drawTask(root, segment, pool, grain);
+        pool.wait();
+    }
+    std::string text;
+    text.reserve(segment.text.size());
+    segment.appendTo(text);
+    out << text;
+}
+
+// A tree with `fanout` children per composite and `depth` levels of composites.
+std::shared_ptr<Graphic> buildTree(int fanout, int depth)
+{
+    auto composite = std::make_shared<CompositeGraphic>();
+    for (int i = 0; i < fanout; ++i)
+    {
+        if (depth > 1)
+            composite->add(buildTree(fanout, depth - 1));
+        else if (i % 2)
+            composite->add(std::make_shared<Square>());
+        else
+            composite->add(std::make_shared<Circle>());
+    }
+    return composite;
+}
+
+// Client
+int main()
+{
+    std::shared_ptr<Circle> circle1 = std::make_shared<Circle>();
+    std::shared_ptr<Square> square1 = std::make_shared<Square>();
+    std::shared_ptr<Circle> circle2 = std::make_shared<Circle>();
+
+    std::shared_ptr<CompositeGraphic> composite = std::make_shared<CompositeGraphic>();
+    composite->add(circle1);
+    composite->add(square1);
+
+    std::shared_ptr<CompositeGraphic> mainComposite = std::make_shared<CompositeGraphic>();
+    mainComposite->add(composite);
+    mainComposite->add(circle2);
+
+    drawParallel(*mainComposite, std::cout, 2, 1);
+
+    // Scaling on a tree with about 300 thousand nodes.
+    auto tree = buildTree(8, 6);
+    std::ostringstream serial;
+    auto start = std::chrono::steady_clock::now();
+    tree->draw(serial);
+    std::chrono::duration<double, std::milli> serialTime = std::chrono::steady_clock::now() - start;
+    std::cout << "Serial draw of " << tree->size() << " nodes: " << serialTime.count() << " ms" << std::endl;
+
+    bool allMatch = true;
+    unsigned maxThreads = std::max(4u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        std::ostringstream parallel;
+        start = std::chrono::steady_clock::now();
+        drawParallel(*tree, parallel, threads);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        bool match = parallel.str() == serial.str();
+        allMatch = allMatch && match;
+        std::cout << "  " << threads << " thread(s): " << elapsed.count() << " ms, output "
+                  << (match ? "identical" : "DIFFERENT") << std::endl;
+    }
+
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,406 @@
+/*
+ * Asynchronous Observer Pattern Example
+ * ---------------------------------------
+ * In the classic Observer Pattern setState() calls every observer's update() inline,
+ * so the thread that changes the state pays for all observers before it can continue.
+ *
+ * AsyncSubject decouples the two sides:
+ * - setState() only appends the new state to a bounded log and returns.
+ * - A pool of worker threads delivers the logged states to the observers.
+ *   Each observer keeps its own position in the log, so it always sees states in order,
+ *   and a slow observer never holds back a fast one.
+ * - In "latest value wins" mode an observer that fell behind receives only the newest state,
+ *   and a full log simply forgets its oldest state instead of applying backpressure.
+ * - When the log is full the configured backpressure policy decides what happens:
+ *   block the producer, drop the oldest logged state or drop the new one.
+ */
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+// Observer interface defining the update method.
+class Observer
+{
+public:
+    virtual void update(const std::string &message) = 0;
+    virtual ~Observer() = default;
+};
+
+// What setState() does when the log is full.
+enum class Backpressure
+{
+    Block,      // Wait until the slowest observer catches up.
+    DropOldest, // Discard the oldest logged state, observers behind it skip it.
+    DropNewest  // Discard the state being set.
+};
+
+struct AsyncOptions
+{
+    std::size_t capacity = 64;
+    unsigned workers = 2;
+    bool latestOnly = false;
+    Backpressure backpressure = Backpressure::Block;
+};
+
+// Counters describing what happened to the published states.
+struct AsyncStats
+{
+    long published = 0;
+    long delivered = 0;
+    long coalesced = 0; // Skipped because a newer state was already pending.
+    long dropped = 0;   // Removed by the backpressure policy.
+};
+
+// Subject that notifies its observers on worker threads.
+class AsyncSubject
+{
+private:
+    using State = std::shared_ptr<const std::string>;
+
+    struct Subscription
+    {
+        std::shared_ptr<Observer> observer;
+        std::uint64_t cursor; // Sequence number of the next state to deliver.
+        bool busy = false;    // A worker is currently delivering to this observer.
+        bool removed = false;
+    };
+
+    AsyncOptions options_;
+    std::deque<State> log_;
+    std::uint64_t base_ = 0; // Sequence number of log_.front().
+    std::vector<std::unique_ptr<Subscription>> subscriptions_;
+    std::size_t nextScan_ = 0;
+    State state_ = std::make_shared<const std::string>();
+    AsyncStats stats_;
+    bool stopping_ = false;
+
+    mutable std::mutex mutex_;
+    std::condition_variable workReady_;
+    std::condition_variable notFull_;
+    std::condition_variable idle_;
+    std::vector<std::thread> workers_;
+
+    std::uint64_t head() const
+    {
+        return base_ + log_.size();
+    }
+
+    // Find an observer that has undelivered states and nobody is serving.
+    Subscription *findPending()
+    {
+        for (std::size_t i = 0; i < subscriptions_.size(); ++i)
+        {
+            auto &subscription = subscriptions_[(nextScan_ + i) % subscriptions_.size()];
+            if (!subscription->busy && !subscription->removed && subscription->cursor < head())
+            {
+                nextScan_ = (nextScan_ + i + 1) % subscriptions_.size();
+                return subscription.get();
+            }
+        }
+        return nullptr;
+    }
+
+    // Drop log entries that every observer has already received.
+    void trim()
+    {
+        std::uint64_t lowest = head();
+        for (const auto &subscription : subscriptions_)
+        {
+            lowest = std::min(lowest, subscription->cursor);
+        }
+        while (base_ < lowest)
+        {
+            log_.pop_front();
+            ++base_;
+        }
+    }
+
+    bool allDelivered() const
+    {
+        for (const auto &subscription : subscriptions_)
+        {
+            if (subscription->busy || subscription->cursor < head())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            Subscription *subscription = nullptr;
+            workReady_.wait(lock, [&]()
+                            { return (subscription = findPending()) != nullptr || stopping_; });
+            if (!subscription)
+            {
+                return;
+            }
+
+            std::uint64_t from = std::max(subscription->cursor, base_);
+            std::uint64_t to = head();
+            if (options_.latestOnly && to - from > 1)
+            {
+                stats_.coalesced += static_cast<long>(to - from - 1);
+                from = to - 1;
+            }
+            std::vector<State> batch(log_.begin() + (from - base_), log_.begin() + (to - base_));
+            subscription->busy = true;
+
+            lock.unlock();
+            for (const auto &state : batch)
+            {
+                subscription->observer->update(*state);
+            }
+            lock.lock();
+
+            subscription->busy = false;
+            subscription->cursor = std::max(subscription->cursor, to);
+            stats_.delivered += static_cast<long>(batch.size());
+            if (subscription->removed)
+            {
+                subscriptions_.erase(
+                    std::find_if(subscriptions_.begin(), subscriptions_.end(),
+                                 [&](const std::unique_ptr<Subscription> &s)
+                                 { return s.get() == subscription; }));
+            }
+            trim();
+            notFull_.notify_all();
+            idle_.notify_all();
+        }
+    }
+
+public:
+    explicit AsyncSubject(const AsyncOptions &options = AsyncOptions()) : options_(options)
+    {
+        options_.capacity = std::max<std::size_t>(1, options_.capacity);
+        for (unsigned i = 0; i < std::max(1u, options_.workers); ++i)
+        {
+            workers_.emplace_back(&AsyncSubject::workerLoop, this);
+        }
+    }
+
+    AsyncSubject(const AsyncSubject &) = delete;
+    AsyncSubject &operator=(const AsyncSubject &) = delete;
+
+    // Delivers everything still pending, then stops the workers.
+    ~AsyncSubject()
+    {
+        flush();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        workReady_.notify_all();
+        notFull_.notify_all();
+        for (auto &worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    // Register an observer. It receives only states set after this call.
+    void addObserver(const std::shared_ptr<Observer> &observer)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        subscriptions_.push_back(std::make_unique<Subscription>(Subscription{observer, head()}));
+    }
+
+    // Remove an observer. A delivery already in progress is allowed to finish.
+    void removeObserver(const std::shared_ptr<Observer> &observer)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = subscriptions_.begin(); it != subscriptions_.end();)
+        {
+            if ((*it)->observer != observer)
+            {
+                ++it;
+            }
+            else if ((*it)->busy)
+            {
+                (*it)->removed = true;
+                ++it;
+            }
+            else
+            {
+                it = subscriptions_.erase(it);
+            }
+        }
+        trim();
+        notFull_.notify_all();
+    }
+
+    // Change the state and schedule the notification. Returns false if the state was dropped.
+    bool setState(std::string state)
+    {
+        auto shared = std::make_shared<const std::string>(std::move(state));
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (log_.size() >= options_.capacity && options_.latestOnly)
+            {
+                // Observers would skip the oldest state anyway, no need to wait for them.
+                log_.pop_front();
+                ++base_;
+                ++stats_.coalesced;
+            }
+            else if (log_.size() >= options_.capacity)
+            {
+                switch (options_.backpressure)
+                {
+                case Backpressure::Block:
+                    notFull_.wait(lock, [&]()
+                                  { return log_.size() < options_.capacity || stopping_; });
+                    break;
+                case Backpressure::DropOldest:
+                    log_.pop_front();
+                    ++base_;
+                    ++stats_.dropped;
+                    break;
+                case Backpressure::DropNewest:
+                    ++stats_.dropped;
+                    return false;
+                }
+            }
+            state_ = shared;
+            if (!subscriptions_.empty())
+            {
+                log_.push_back(std::move(shared));
+            }
+            ++stats_.published;
+        }
+        workReady_.notify_one();
+        return true;
+    }
+
+    // Wait until every logged state has been delivered.
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [&]()
+                   { return allDelivered(); });
+    }
+
+    std::string getState() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return *state_;
+    }
+
+    AsyncStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+};
+
+// A concrete observer that reacts to state changes.
+class ConcreteObserver : public Observer
+{
+private:
+    std::string name_;
+
+public:
+    ConcreteObserver(const std::string &name) : name_(name) {}
+
+    void update(const std::string &message) override
+    {
+        std::cout << "Observer [" << name_ << "] received update: " << message << std::endl;
+    }
+};
+
+// An observer that takes its time on every update.
+class SlowObserver : public Observer
+{
+private:
+    std::chrono::microseconds delay_;
+    std::atomic<long> received_{0};
+
+public:
+    explicit SlowObserver(std::chrono::microseconds delay) : delay_(delay) {}
+
+    void update(const std::string &) override
+    {
+        std::this_thread::sleep_for(delay_);
+        ++received_;
+    }
+
+    long received() const
+    {
+        return received_.load();
+    }
+};
+
+// Publish a burst of states to one slow observer and report producer latency and delivery counts.
+void runBurst(const char *label, const AsyncOptions &options)
+{
+    auto slow = std::make_shared<SlowObserver>(std::chrono::microseconds(500));
+    std::chrono::duration<double, std::micro> worst{0};
+    AsyncStats stats;
+    {
+        AsyncSubject subject(options);
+        subject.addObserver(slow);
+        for (int i = 0; i < 200; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            subject.setState("state " + std::to_string(i));
+            worst = std::max<std::chrono::duration<double, std::micro>>(worst, std::chrono::steady_clock::now() - start);
+        }
+        subject.flush();
+        stats = subject.stats();
+    }
+    std::cout << "  " << label << ": worst setState " << static_cast<long>(worst.count()) << " us"
+              << ", published " << stats.published << ", delivered " << slow->received()
+              << ", coalesced " << stats.coalesced << ", dropped " << stats.dropped << std::endl;
+}
+
+int main()
+{
+    {
+        AsyncSubject subject;
+
+        std::shared_ptr<Observer> observer1 = std::make_shared<ConcreteObserver>("Observer1");
+        std::shared_ptr<Observer> observer2 = std::make_shared<ConcreteObserver>("Observer2");
+
+        subject.addObserver(observer1);
+        subject.addObserver(observer2);
+
+        // setState returns immediately, the updates arrive on worker threads.
+        subject.setState("State 1: Data Updated");
+        subject.flush();
+
+        subject.removeObserver(observer1);
+        subject.setState("State 2: New Information");
+    } // The destructor delivers whatever is still pending.
+
+    std::cout << "Burst of 200 states to a slow observer:" << std::endl;
+
+    AsyncOptions options;
+    options.capacity = 16;
+
+    options.backpressure = Backpressure::Block;
+    runBurst("block        ", options);
+
+    options.backpressure = Backpressure::DropOldest;
+    runBurst("drop oldest  ", options);
+
+    options.backpressure = Backpressure::DropNewest;
+    runBurst("drop newest  ", options);
+
+    options.backpressure = Backpressure::Block;
+    options.latestOnly = true;
+    runBurst("latest wins  ", options);
+
+    return 0;
+}
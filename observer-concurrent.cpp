@@ -0,0 +1,336 @@
+/*
+ * Concurrent Observer Pattern Example
+ * -------------------------------------
+ * This example extends the Observer Pattern with a Subject that can be notified
+ * from many threads while observers are being added and removed.
+ *
+ * The observer list is kept as an immutable snapshot (read-copy-update):
+ * - Notifiers read the current snapshot without taking any lock and iterate it.
+ * - addObserver/removeObserver copy the snapshot, modify the copy and publish it
+ *   atomically. The old snapshot is freed only after every notifier that could
+ *   still be reading it has finished (a "grace period").
+ *
+ * Note: an observer must not add or remove observers of the same Subject from
+ * inside update(), because the writer would wait for its own notification.
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+
+// Observer interface defining the update method.
+class Observer
+{
+public:
+    virtual void update(const std::string &message) = 0;
+    virtual ~Observer() = default;
+};
+
+// Tracks the notifiers that are currently reading a snapshot.
+// Readers only increment and decrement a counter, writers wait for the counters to drain.
+// Counters are striped across cache lines so that notifier threads do not fight over one line.
+class ReadEpoch
+{
+private:
+    static constexpr std::size_t kStripes = 16;
+
+    struct alignas(64) Counter
+    {
+        std::atomic<long> readers{0};
+    };
+
+    std::atomic<unsigned> epoch_{0};
+    Counter counters_[2][kStripes];
+
+    static std::size_t stripe()
+    {
+        static std::atomic<std::size_t> nextStripe{0};
+        thread_local std::size_t index = nextStripe.fetch_add(1) % kStripes;
+        return index;
+    }
+
+    void waitForReaders(unsigned epoch) const
+    {
+        for (const auto &counter : counters_[epoch])
+        {
+            while (counter.readers.load() != 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+public:
+    // Enter a read-side section, returns the token needed to leave it.
+    unsigned enter()
+    {
+        unsigned epoch = epoch_.load() & 1;
+        counters_[epoch][stripe()].readers.fetch_add(1);
+        return epoch;
+    }
+
+    void leave(unsigned epoch)
+    {
+        counters_[epoch][stripe()].readers.fetch_sub(1);
+    }
+
+    // A read-side section for the lifetime of the object, left even if the reader throws.
+    class Section
+    {
+    private:
+        ReadEpoch &readers_;
+        unsigned epoch_;
+
+    public:
+        explicit Section(ReadEpoch &readers) : readers_(readers), epoch_(readers.enter()) {}
+        Section(const Section &) = delete;
+        Section &operator=(const Section &) = delete;
+        ~Section() { readers_.leave(epoch_); }
+    };
+
+    // Wait until every reader that entered before this call has left.
+    // Flipping twice guarantees that readers which picked either counter are covered.
+    void synchronize()
+    {
+        for (int phase = 0; phase < 2; ++phase)
+        {
+            unsigned previous = epoch_.fetch_add(1) & 1;
+            waitForReaders(previous);
+        }
+    }
+};
+
+// Subject whose observer list is published as an immutable snapshot.
+class ConcurrentSubject
+{
+private:
+    using ObserverList = std::vector<std::shared_ptr<Observer>>;
+
+    std::atomic<const ObserverList *> observers_;
+    mutable ReadEpoch readers_;
+    std::mutex writeMutex_; // Serializes writers only, notifiers never take it.
+
+    // Swap in a new snapshot and free the old one once no notifier can see it.
+    void publish(const ObserverList *next)
+    {
+        const ObserverList *previous = observers_.exchange(next);
+        readers_.synchronize();
+        delete previous;
+    }
+
+public:
+    ConcurrentSubject() : observers_(new ObserverList()) {}
+
+    ConcurrentSubject(const ConcurrentSubject &) = delete;
+    ConcurrentSubject &operator=(const ConcurrentSubject &) = delete;
+
+    ~ConcurrentSubject()
+    {
+        delete observers_.load();
+    }
+
+    // Register an observer.
+    void addObserver(const std::shared_ptr<Observer> &observer)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        auto next = new ObserverList(*observers_.load());
+        next->push_back(observer);
+        publish(next);
+    }
+
+    // Remove an observer.
+    void removeObserver(const std::shared_ptr<Observer> &observer)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        auto next = new ObserverList(*observers_.load());
+        next->erase(
+            std::remove(next->begin(), next->end(), observer),
+            next->end());
+        publish(next);
+    }
+
+    // Notify all observers of the snapshot that is current at the time of the call.
+    // Safe to call from any number of threads at once. An exception from an observer stops
+    // the notification and propagates to the caller.
+    void notifyObservers(const std::string &state) const
+    {
+        ReadEpoch::Section section(readers_);
+        const ObserverList *snapshot = observers_.load();
+        for (const auto &observer : *snapshot)
+        {
+            observer->update(state);
+        }
+    }
+
+    std::size_t observerCount() const
+    {
+        ReadEpoch::Section section(readers_);
+        return observers_.load()->size();
+    }
+};
+
+// An observer whose update always fails.
+class FailingObserver : public Observer
+{
+public:
+    void update(const std::string &) override
+    {
+        throw std::runtime_error("observer failed");
+    }
+};
+
+// A concrete observer that reacts to state changes.
+class ConcreteObserver : public Observer
+{
+private:
+    std::string name_;
+
+public:
+    ConcreteObserver(const std::string &name) : name_(name) {}
+
+    void update(const std::string &message) override
+    {
+        std::cout << "Observer [" << name_ << "] received update: " << message << std::endl;
+    }
+};
+
+// An observer that only counts notifications, used by the stress test and benchmark.
+class CountingObserver : public Observer
+{
+private:
+    std::atomic<long> count_{0};
+
+public:
+    void update(const std::string &) override
+    {
+        count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    long count() const
+    {
+        return count_.load();
+    }
+};
+
+// Several threads notify while another thread keeps adding and removing observers.
+// The permanent observer must see every single notification.
+bool stressTest(unsigned notifierCount, int notificationsPerThread)
+{
+    ConcurrentSubject subject;
+    auto permanent = std::make_shared<CountingObserver>();
+    subject.addObserver(permanent);
+
+    std::atomic<bool> done{false};
+    std::thread churn([&]()
+                      {
+        while (!done.load())
+        {
+            auto temporary = std::make_shared<CountingObserver>();
+            subject.addObserver(temporary);
+            subject.removeObserver(temporary);
+        } });
+
+    std::vector<std::thread> notifiers;
+    for (unsigned t = 0; t < notifierCount; ++t)
+    {
+        notifiers.emplace_back([&]()
+                               {
+            for (int i = 0; i < notificationsPerThread; ++i)
+            {
+                subject.notifyObservers("tick");
+            } });
+    }
+    for (auto &notifier : notifiers)
+    {
+        notifier.join();
+    }
+    done = true;
+    churn.join();
+
+    long expected = static_cast<long>(notifierCount) * notificationsPerThread;
+    return permanent->count() == expected && subject.observerCount() == 1;
+}
+
+// Measures notifications per second for a growing number of notifier threads.
+void benchmark(unsigned maxThreads, int observerCount, int notificationsPerThread)
+{
+    ConcurrentSubject subject;
+    for (int i = 0; i < observerCount; ++i)
+    {
+        subject.addObserver(std::make_shared<CountingObserver>());
+    }
+
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> notifiers;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            notifiers.emplace_back([&]()
+                                   {
+                for (int i = 0; i < notificationsPerThread; ++i)
+                {
+                    subject.notifyObservers("tick");
+                } });
+        }
+        for (auto &notifier : notifiers)
+        {
+            notifier.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        double total = static_cast<double>(threads) * notificationsPerThread;
+        std::cout << "  " << threads << " thread(s): "
+                  << static_cast<long>(total / elapsed.count()) << " notifications/s" << std::endl;
+    }
+}
+
+int main()
+{
+    // Basic usage is the same as with the single-threaded Subject.
+    ConcurrentSubject subject;
+
+    std::shared_ptr<Observer> observer1 = std::make_shared<ConcreteObserver>("Observer1");
+    std::shared_ptr<Observer> observer2 = std::make_shared<ConcreteObserver>("Observer2");
+
+    subject.addObserver(observer1);
+    subject.addObserver(observer2);
+    subject.notifyObservers("State 1: Data Updated");
+
+    subject.removeObserver(observer1);
+    subject.notifyObservers("State 2: New Information");
+
+    // A throwing observer must not leave the notifier inside its read-side section,
+    // or the next removeObserver() would wait for it forever.
+    std::shared_ptr<Observer> failing = std::make_shared<FailingObserver>();
+    subject.addObserver(failing);
+    bool thrown = false;
+    try
+    {
+        subject.notifyObservers("State 3: Failing Observer");
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    subject.removeObserver(failing);
+    std::cout << "Failing observer " << (thrown ? "reported and removed" : "NOT reported") << std::endl;
+
+    // Stress test: notifications from many threads during observer churn.
+    unsigned cores = std::max(2u, std::thread::hardware_concurrency());
+    bool ok = stressTest(cores, 20000);
+    std::cout << "Stress test " << (ok ? "passed" : "FAILED") << std::endl;
+
+    // Benchmark: notify throughput against the number of notifier threads.
+    std::cout << "Notify throughput (8 observers):" << std::endl;
+    benchmark(cores, 8, 200000);
+
+    return ok && thrown ? 0 : 1;
+}
@@ -0,0 +1,246 @@
+/*
+ * Observer Pattern with Subscription Tokens
+ * -------------------------------------------
+ * The classic Subject removes an observer by searching the whole list, and keeps every
+ * observer alive through a shared_ptr even after the rest of the program dropped it.
+ *
+ * This Subject stores observers in a slot map:
+ * - addObserver() returns a Subscription token (slot index + generation).
+ * - removeObserver(token) is O(1): the entry is swapped with the last one in a dense array.
+ * - Notification iterates the dense array, so it stays contiguous however much churn happened.
+ *   The price is that removals may change the order in which observers are notified.
+ * - A token whose observer was already removed is recognized by its stale generation.
+ *
+ * In weak mode the Subject holds only weak references. Observers that expired elsewhere are
+ * pruned lazily, the next time notifyObservers() comes across them.
+ */
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <chrono>
+
+// Observer interface defining the update method.
+class Observer
+{
+public:
+    virtual void update(const std::string &message) = 0;
+    virtual ~Observer() = default;
+};
+
+// Identifies one registration of an observer.
+struct Subscription
+{
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0;
+};
+
+// Whether the Subject keeps its observers alive.
+enum class Ownership
+{
+    Strong,
+    Weak
+};
+
+// Subject that keeps its observers in a slot map.
+class Subject
+{
+private:
+    struct Entry
+    {
+        std::shared_ptr<Observer> strong; // Empty in weak mode.
+        std::weak_ptr<Observer> weak;
+        std::uint32_t slot; // Slot that points back to this entry.
+    };
+
+    struct Slot
+    {
+        std::uint32_t dense = 0; // Position in entries_ while the slot is in use.
+        std::uint32_t generation = 0;
+        std::uint32_t nextFree = 0;
+    };
+
+    static constexpr std::uint32_t kNoSlot = UINT32_MAX;
+
+    Ownership ownership_;
+    std::vector<Entry> entries_;
+    std::vector<Slot> slots_;
+    std::uint32_t freeHead_ = kNoSlot;
+    std::string state_;
+
+    // Remove the entry at a dense position by moving the last entry into its place.
+    void eraseDense(std::uint32_t dense)
+    {
+        Slot &slot = slots_[entries_[dense].slot];
+        ++slot.generation;
+        slot.nextFree = freeHead_;
+        freeHead_ = entries_[dense].slot;
+
+        if (dense != entries_.size() - 1)
+        {
+            entries_[dense] = std::move(entries_.back());
+            slots_[entries_[dense].slot].dense = dense;
+        }
+        entries_.pop_back();
+    }
+
+public:
+    explicit Subject(Ownership ownership = Ownership::Strong) : ownership_(ownership) {}
+
+    // Register an observer and return the token needed to remove it.
+    Subscription addObserver(const std::shared_ptr<Observer> &observer)
+    {
+        std::uint32_t index;
+        if (freeHead_ != kNoSlot)
+        {
+            index = freeHead_;
+            freeHead_ = slots_[index].nextFree;
+        }
+        else
+        {
+            index = static_cast<std::uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+
+        slots_[index].dense = static_cast<std::uint32_t>(entries_.size());
+        entries_.push_back(Entry{ownership_ == Ownership::Strong ? observer : nullptr, observer, index});
+        return Subscription{index, slots_[index].generation};
+    }
+
+    // Whether the token still refers to a registered observer.
+    bool isSubscribed(Subscription subscription) const
+    {
+        return subscription.index < slots_.size() &&
+               slots_[subscription.index].generation == subscription.generation;
+    }
+
+    // Remove an observer in constant time. Returns false for a stale token.
+    bool removeObserver(Subscription subscription)
+    {
+        if (!isSubscribed(subscription))
+        {
+            return false;
+        }
+        eraseDense(slots_[subscription.index].dense);
+        return true;
+    }
+
+    // Change the state and notify all observers.
+    void setState(const std::string &state)
+    {
+        state_ = state;
+        notifyObservers();
+    }
+
+    // Notify all registered observers, pruning the ones that expired in weak mode.
+    void notifyObservers()
+    {
+        std::uint32_t i = 0;
+        while (i < entries_.size())
+        {
+            if (ownership_ == Ownership::Strong)
+            {
+                entries_[i++].strong->update(state_);
+            }
+            else if (auto observer = entries_[i].weak.lock())
+            {
+                observer->update(state_);
+                ++i;
+            }
+            else
+            {
+                // The last entry moves into position i, so i is not advanced.
+                eraseDense(i);
+            }
+        }
+    }
+
+    std::size_t observerCount() const
+    {
+        return entries_.size();
+    }
+
+    std::string getState() const
+    {
+        return state_;
+    }
+};
+
+// A concrete observer that reacts to state changes.
+class ConcreteObserver : public Observer
+{
+private:
+    std::string name_;
+
+public:
+    ConcreteObserver(const std::string &name) : name_(name) {}
+
+    void update(const std::string &message) override
+    {
+        std::cout << "Observer [" << name_ << "] received update: " << message << std::endl;
+    }
+};
+
+// An observer that does nothing, used to measure subscription churn.
+class SilentObserver : public Observer
+{
+public:
+    void update(const std::string &) override {}
+};
+
+int main()
+{
+    Subject subject;
+
+    std::shared_ptr<Observer> observer1 = std::make_shared<ConcreteObserver>("Observer1");
+    std::shared_ptr<Observer> observer2 = std::make_shared<ConcreteObserver>("Observer2");
+
+    Subscription subscription1 = subject.addObserver(observer1);
+    subject.addObserver(observer2);
+    subject.setState("State 1: Data Updated");
+
+    // Remove one observer through its token and change state again.
+    subject.removeObserver(subscription1);
+    subject.setState("State 2: New Information");
+
+    // The token is stale now, removing it again is a no-op.
+    std::cout << "Second removal succeeded: " << std::boolalpha << subject.removeObserver(subscription1) << std::endl;
+
+    // In weak mode an observer dropped by its owner is pruned on the next notification.
+    Subject weakSubject(Ownership::Weak);
+    auto temporary = std::make_shared<ConcreteObserver>("Temporary");
+    weakSubject.addObserver(observer2);
+    weakSubject.addObserver(temporary);
+    weakSubject.setState("State 3: Both alive");
+    temporary.reset();
+    weakSubject.setState("State 4: Temporary expired");
+    std::cout << "Observers left in weak subject: " << weakSubject.observerCount() << std::endl;
+
+    // Churn: many short-lived subscribers on top of a large stable population.
+    Subject churnSubject;
+    auto silent = std::make_shared<SilentObserver>();
+    for (int i = 0; i < 100000; ++i)
+    {
+        churnSubject.addObserver(silent);
+    }
+    std::vector<Subscription> shortLived(1000);
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < 1000; ++round)
+    {
+        for (auto &subscription : shortLived)
+        {
+            subscription = churnSubject.addObserver(silent);
+        }
+        for (auto &subscription : shortLived)
+        {
+            churnSubject.removeObserver(subscription);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Subscribe + unsubscribe with 100000 observers registered: "
+              << static_cast<long>(elapsed.count() / 1000000) << " ns" << std::endl;
+
+    return 0;
+}
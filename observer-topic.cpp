@@ -0,0 +1,236 @@
+/*
+ * Topic-Based Observer Pattern Example
+ * --------------------------------------
+ * The classic Subject broadcasts every change to every observer, even to observers
+ * that do not care about it. With many observers that each watch a few keys, most
+ * update() calls are wasted.
+ *
+ * TopicSubject lets observers subscribe to specific topics instead:
+ * - An exact subscription ("sensor.temperature") is found through a hash index.
+ * - A wildcard subscription ending with '*' ("sensor.*", or "*" for everything)
+ *   matches every topic with that prefix. Prefixes are indexed by their length, so
+ *   publishing only looks up the prefix lengths that are actually in use.
+ *
+ * The cost of publish() therefore depends on the number of interested observers,
+ * not on the total number of subscriptions.
+ */
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <map>
+#include <chrono>
+
+// Observer interface, receives the topic together with the message.
+class Observer
+{
+public:
+    virtual void update(const std::string &topic, const std::string &message) = 0;
+    virtual ~Observer() = default;
+};
+
+// Subject that routes each message only to the subscribers of its topic.
+class TopicSubject
+{
+private:
+    using Observers = std::vector<std::shared_ptr<Observer>>;
+
+    // The index is keyed by a view into the entry's own name, so lookups need no allocation.
+    struct TopicEntry
+    {
+        std::string name;
+        Observers observers;
+    };
+    using Index = std::unordered_map<std::string_view, std::unique_ptr<TopicEntry>>;
+
+    Index exact_;
+    Index prefixes_;
+    std::map<std::size_t, int> prefixLengths_; // Prefix length -> number of prefixes with it.
+
+    static bool isWildcard(const std::string &pattern)
+    {
+        return !pattern.empty() && pattern.back() == '*';
+    }
+
+    static void add(Index &index, std::string_view key, const std::shared_ptr<Observer> &observer)
+    {
+        auto it = index.find(key);
+        if (it == index.end())
+        {
+            auto entry = std::make_unique<TopicEntry>();
+            entry->name = std::string(key);
+            std::string_view name = entry->name;
+            it = index.emplace(name, std::move(entry)).first;
+        }
+        it->second->observers.push_back(observer);
+    }
+
+    // Returns true when the key lost its last observer and was removed from the index.
+    static bool remove(Index &index, std::string_view key, const std::shared_ptr<Observer> &observer)
+    {
+        auto it = index.find(key);
+        if (it == index.end())
+        {
+            return false;
+        }
+        auto &observers = it->second->observers;
+        observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+        if (!observers.empty())
+        {
+            return false;
+        }
+        index.erase(it);
+        return true;
+    }
+
+    static void deliver(const Index &index, std::string_view key,
+                        const std::string &topic, const std::string &message)
+    {
+        auto it = index.find(key);
+        if (it == index.end())
+        {
+            return;
+        }
+        for (const auto &observer : it->second->observers)
+        {
+            observer->update(topic, message);
+        }
+    }
+
+public:
+    // Subscribe to a topic, or to every topic with a given prefix when the pattern ends with '*'.
+    void subscribe(const std::string &pattern, const std::shared_ptr<Observer> &observer)
+    {
+        if (!isWildcard(pattern))
+        {
+            add(exact_, pattern, observer);
+            return;
+        }
+        std::string_view prefix(pattern.data(), pattern.size() - 1);
+        if (prefixes_.find(prefix) == prefixes_.end())
+        {
+            ++prefixLengths_[prefix.size()];
+        }
+        add(prefixes_, prefix, observer);
+    }
+
+    // Remove a subscription made with the same pattern.
+    void unsubscribe(const std::string &pattern, const std::shared_ptr<Observer> &observer)
+    {
+        if (!isWildcard(pattern))
+        {
+            remove(exact_, pattern, observer);
+            return;
+        }
+        std::string_view prefix(pattern.data(), pattern.size() - 1);
+        if (remove(prefixes_, prefix, observer) && --prefixLengths_[prefix.size()] == 0)
+        {
+            prefixLengths_.erase(prefix.size());
+        }
+    }
+
+    // Notify the observers of the topic and of every wildcard that matches it.
+    // An observer with several matching subscriptions is notified once per subscription.
+    void publish(const std::string &topic, const std::string &message) const
+    {
+        deliver(exact_, topic, topic, message);
+        for (const auto &length : prefixLengths_)
+        {
+            if (length.first > topic.size())
+            {
+                break;
+            }
+            deliver(prefixes_, std::string_view(topic.data(), length.first), topic, message);
+        }
+    }
+};
+
+// A concrete observer that reacts to state changes.
+class ConcreteObserver : public Observer
+{
+private:
+    std::string name_;
+
+public:
+    ConcreteObserver(const std::string &name) : name_(name) {}
+
+    void update(const std::string &topic, const std::string &message) override
+    {
+        std::cout << "Observer [" << name_ << "] received update on " << topic << ": " << message << std::endl;
+    }
+};
+
+// An observer that only counts notifications, used by the benchmark.
+class CountingObserver : public Observer
+{
+public:
+    long count = 0;
+
+    void update(const std::string &, const std::string &) override
+    {
+        ++count;
+    }
+};
+
+// Publish to one topic while the total number of subscribers grows.
+// Every topic has the same number of subscribers, so the interested set stays constant.
+void benchmark(int subscribersPerTopic, int publishes)
+{
+    for (int total : {1000, 10000, 100000, 1000000})
+    {
+        TopicSubject subject;
+        std::vector<std::shared_ptr<CountingObserver>> observers;
+        for (int i = 0; i < total; ++i)
+        {
+            observers.push_back(std::make_shared<CountingObserver>());
+            subject.subscribe("key." + std::to_string(i / subscribersPerTopic), observers.back());
+        }
+        subject.subscribe("alerts.*", std::make_shared<CountingObserver>());
+
+        const std::string topic = "key.7";
+        const std::string message = "value";
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < publishes; ++i)
+        {
+            subject.publish(topic, message);
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "  " << total << " subscribers: "
+                  << static_cast<long>(elapsed.count() / publishes) << " ns/publish" << std::endl;
+    }
+}
+
+int main()
+{
+    TopicSubject subject;
+
+    std::shared_ptr<Observer> thermometer = std::make_shared<ConcreteObserver>("Thermometer");
+    std::shared_ptr<Observer> dashboard = std::make_shared<ConcreteObserver>("Dashboard");
+    std::shared_ptr<Observer> logger = std::make_shared<ConcreteObserver>("Logger");
+
+    subject.subscribe("sensor.temperature", thermometer);
+    subject.subscribe("sensor.*", dashboard);
+    subject.subscribe("*", logger);
+
+    // Thermometer, Dashboard and Logger are notified.
+    subject.publish("sensor.temperature", "21.5 C");
+
+    // Only Dashboard and Logger are notified.
+    subject.publish("sensor.humidity", "40 %");
+
+    // Only Logger is notified.
+    subject.publish("system.status", "OK");
+
+    subject.unsubscribe("sensor.*", dashboard);
+    subject.publish("sensor.humidity", "42 %");
+
+    std::cout << "Dispatch cost with 4 subscribers per topic:" << std::endl;
+    benchmark(4, 1000000);
+
+    return 0;
+}
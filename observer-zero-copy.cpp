@@ -0,0 +1,193 @@
+/*
+ * Zero-Copy Observer Pattern Example
+ * ------------------------------------
+ * The classic Subject copies the state into state_ on every change, and getState()
+ * returns yet another copy. With large payloads those copies dominate.
+ *
+ * EventChannel<Event> avoids them:
+ * - publish() takes the payload by value, so callers can move it in. It is then stored
+ *   once as an immutable, reference-counted buffer.
+ * - Observers receive a view of that buffer (std::string_view for strings, a const
+ *   reference otherwise), so notifying any number of observers copies nothing and
+ *   allocates nothing.
+ * - getState() hands out another reference to the same buffer instead of a copy.
+ */
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <cstdlib>
+#include <new>
+
+// Counts heap allocations so the example can show that notifying does not allocate.
+static long allocationCount = 0;
+
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// How an observer sees an event of a given type. By default it gets a const reference.
+template <typename Event>
+struct EventView
+{
+    using type = const Event &;
+    static type of(const Event &event) { return event; }
+};
+
+// Strings are seen through a string_view.
+template <>
+struct EventView<std::string>
+{
+    using type = std::string_view;
+    static type of(const std::string &event) { return event; }
+};
+
+// Observer interface for events of a given type.
+template <typename Event>
+class Observer
+{
+public:
+    virtual void update(typename EventView<Event>::type event) = 0;
+    virtual ~Observer() = default;
+};
+
+// Subject that stores each published event once and lends it to observers.
+template <typename Event>
+class EventChannel
+{
+public:
+    using EventPtr = std::shared_ptr<const Event>;
+
+private:
+    std::vector<std::shared_ptr<Observer<Event>>> observers_;
+    EventPtr state_ = std::make_shared<const Event>();
+
+public:
+    void addObserver(const std::shared_ptr<Observer<Event>> &observer)
+    {
+        observers_.push_back(observer);
+    }
+
+    void removeObserver(const std::shared_ptr<Observer<Event>> &observer)
+    {
+        observers_.erase(
+            std::remove(observers_.begin(), observers_.end(), observer),
+            observers_.end());
+    }
+
+    // Move the event into an immutable buffer and notify all observers.
+    // The only allocation is the buffer's control block, the payload itself is not copied.
+    void publish(Event event)
+    {
+        state_ = std::make_shared<const Event>(std::move(event));
+        notifyObservers();
+    }
+
+    // Notify all observers with a view of the current event. Does not allocate.
+    void notifyObservers() const
+    {
+        auto view = EventView<Event>::of(*state_);
+        for (const auto &observer : observers_)
+        {
+            observer->update(view);
+        }
+    }
+
+    // Share the current event without copying it.
+    EventPtr getState() const
+    {
+        return state_;
+    }
+};
+
+// A concrete observer that reacts to state changes.
+class ConcreteObserver : public Observer<std::string>
+{
+private:
+    std::string name_;
+
+public:
+    ConcreteObserver(const std::string &name) : name_(name) {}
+
+    void update(std::string_view message) override
+    {
+        std::cout << "Observer [" << name_ << "] received update: " << message << std::endl;
+    }
+};
+
+// An observer that only inspects the payload, used by the allocation check.
+class ChecksumObserver : public Observer<std::string>
+{
+public:
+    unsigned long checksum = 0;
+
+    void update(std::string_view message) override
+    {
+        checksum += message.size() + static_cast<unsigned char>(message.front());
+    }
+};
+
+int main()
+{
+    EventChannel<std::string> subject;
+
+    std::shared_ptr<Observer<std::string>> observer1 = std::make_shared<ConcreteObserver>("Observer1");
+    std::shared_ptr<Observer<std::string>> observer2 = std::make_shared<ConcreteObserver>("Observer2");
+
+    subject.addObserver(observer1);
+    subject.addObserver(observer2);
+    subject.publish("State 1: Data Updated");
+
+    subject.removeObserver(observer1);
+    subject.publish("State 2: New Information");
+
+    // A large payload is moved in, its buffer is never copied.
+    std::string large(1 << 20, 'x');
+    const char *buffer = large.data();
+    subject.removeObserver(observer2);
+    subject.publish(std::move(large));
+    std::cout << "Payload moved without copy: " << (subject.getState()->data() == buffer ? "yes" : "no") << std::endl;
+
+    // Steady-state notification must not touch the heap, whatever the number of observers.
+    std::vector<std::shared_ptr<ChecksumObserver>> checkers;
+    for (int i = 0; i < 1000; ++i)
+    {
+        checkers.push_back(std::make_shared<ChecksumObserver>());
+        subject.addObserver(checkers.back());
+    }
+
+    long before = allocationCount;
+    for (int i = 0; i < 1000; ++i)
+    {
+        subject.notifyObservers();
+    }
+    long notifyAllocations = allocationCount - before;
+
+    before = allocationCount;
+    auto shared = subject.getState();
+    long getStateAllocations = allocationCount - before;
+
+    std::cout << "Allocations during 1000 notifications to 1000 observers: " << notifyAllocations << std::endl;
+    std::cout << "Allocations in getState(): " << getStateAllocations << std::endl;
+
+    return notifyAllocations == 0 && getStateAllocations == 0 ? 0 : 1;
+}
@@ -0,0 +1,287 @@
+/*
+ * Prototype Herd Example
+ * ------------------------
+ * Keeping a large population cloned from a few prototypes as
+ * std::vector<std::unique_ptr<Animal>> scatters the animals (and their separately
+ * allocated years and strings) across the heap, so a pass that ages every animal or
+ * counts the black ones jumps from pointer to pointer.
+ *
+ * Herd stores the animals column-wise (structure of arrays):
+ * - One column each for the species (concrete type) of the prototype the animal was cloned
+ *   from, the name ID, the color ID and the year. Names and colors are kept once in a
+ *   StringTable and referred to by ID.
+ * - cloneN(prototype, n) appends n clones by filling each column in one go.
+ * - Batch operations run as simple loops over one or two columns, which the compiler can
+ *   vectorize.
+ * - materialize(i) builds a regular Animal for a single member when an object is needed,
+ *   by cloning its prototype and applying the member's state.
+ */
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <typeindex>
+
+// Prototype
+class Animal
+{
+public:
+    std::string name;
+    std::string color;
+    std::unique_ptr<int> year = std::make_unique<int>();
+    virtual std::unique_ptr<Animal> clone() const = 0;
+    virtual void speak() const = 0;
+    virtual ~Animal() = default;
+};
+
+// Concrete prototype
+class Sheep : public Animal
+{
+public:
+    Sheep(const std::string &name, const std::string &color)
+    {
+        this->name = name;
+        this->color = color;
+    }
+
+    // For deep copy, especially important with pointers
+    Sheep(const Sheep &other)
+    {
+        name = other.name;
+        color = other.color;
+        year = std::make_unique<int>(*other.year);
+    }
+
+    std::unique_ptr<Animal> clone() const override
+    {
+        return std::make_unique<Sheep>(*this);
+    }
+
+    void speak() const override
+    {
+        std::cout << name << " the " << color << ", year: " << *year << " sheep says: Baa!" << std::endl;
+    }
+};
+
+// Assigns a small integer ID to every distinct string.
+class StringTable
+{
+public:
+    std::uint32_t idOf(const std::string &text)
+    {
+        auto it = ids_.find(text);
+        if (it != ids_.end())
+        {
+            return it->second;
+        }
+        auto id = static_cast<std::uint32_t>(texts_.size());
+        texts_.push_back(text);
+        ids_.emplace(text, id);
+        return id;
+    }
+
+    const std::string &text(std::uint32_t id) const
+    {
+        return texts_[id];
+    }
+
+private:
+    std::vector<std::string> texts_;
+    std::unordered_map<std::string, std::uint32_t> ids_;
+};
+
+// A population of animals stored column-wise.
+class Herd
+{
+public:
+    // Append n clones of the prototype. Returns the index of the first one.
+    std::size_t cloneN(const Animal &prototype, std::size_t n)
+    {
+        std::size_t first = years_.size();
+        std::uint16_t species = speciesOf(prototype);
+        std::uint32_t name = strings_.idOf(prototype.name);
+        std::uint32_t color = strings_.idOf(prototype.color);
+        int year = *prototype.year;
+
+        species_.insert(species_.end(), n, species);
+        names_.insert(names_.end(), n, name);
+        colors_.insert(colors_.end(), n, color);
+        years_.insert(years_.end(), n, year);
+        return first;
+    }
+
+    std::size_t size() const
+    {
+        return years_.size();
+    }
+
+    // ID of a name or color, for use with the batch operations.
+    std::uint32_t idOf(const std::string &text)
+    {
+        return strings_.idOf(text);
+    }
+
+    // --- Batch operations over columns ---
+
+    // Add `years` to the year of every animal.
+    void ageAll(int years)
+    {
+        int *year = years_.data();
+        for (std::size_t i = 0, n = years_.size(); i < n; ++i)
+        {
+            year[i] += years;
+        }
+    }
+
+    // Add `years` to the year of every animal of the given color.
+    void ageWhereColor(std::uint32_t color, int years)
+    {
+        int *year = years_.data();
+        const std::uint32_t *colors = colors_.data();
+        for (std::size_t i = 0, n = years_.size(); i < n; ++i)
+        {
+            year[i] += colors[i] == color ? years : 0;
+        }
+    }
+
+    std::size_t countWithColor(std::uint32_t color) const
+    {
+        std::size_t count = 0;
+        const std::uint32_t *colors = colors_.data();
+        for (std::size_t i = 0, n = colors_.size(); i < n; ++i)
+        {
+            count += colors[i] == color;
+        }
+        return count;
+    }
+
+    void recolor(std::size_t index, const std::string &color)
+    {
+        colors_[index] = strings_.idOf(color);
+    }
+
+    // --- Single members ---
+
+    const std::string &name(std::size_t index) const { return strings_.text(names_[index]); }
+    const std::string &color(std::size_t index) const { return strings_.text(colors_[index]); }
+    int year(std::size_t index) const { return years_[index]; }
+
+    // A standalone Animal with the state of one member. Changing it does not change the herd.
+    std::unique_ptr<Animal> materialize(std::size_t index) const
+    {
+        std::unique_ptr<Animal> animal = prototypes_[species_[index]]->clone();
+        animal->name = name(index);
+        animal->color = color(index);
+        *animal->year = years_[index];
+        return animal;
+    }
+
+private:
+    StringTable strings_;
+    std::vector<std::unique_ptr<Animal>> prototypes_; // One clone per concrete type seen.
+    std::unordered_map<std::type_index, std::uint16_t> speciesIds_;
+
+    std::vector<std::uint16_t> species_;
+    std::vector<std::uint32_t> names_;
+    std::vector<std::uint32_t> colors_;
+    std::vector<int> years_;
+
+    // A species is a concrete Animal type. The columns hold all of Animal's state, so one
+    // stored clone per type is enough to materialize any member of that type.
+    std::uint16_t speciesOf(const Animal &prototype)
+    {
+        std::type_index type(typeid(prototype));
+        auto it = speciesIds_.find(type);
+        if (it != speciesIds_.end())
+        {
+            return it->second;
+        }
+        if (prototypes_.size() > std::numeric_limits<std::uint16_t>::max())
+        {
+            throw std::length_error("Herd: too many species");
+        }
+        auto id = static_cast<std::uint16_t>(prototypes_.size());
+        prototypes_.push_back(prototype.clone());
+        speciesIds_.emplace(type, id);
+        return id;
+    }
+};
+
+double millisSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Client
+int main()
+{
+    Sheep dolly("Dolly", "white");
+    *dolly.year = 12;
+    Sheep shaun("Shaun", "black");
+    *shaun.year = 3;
+
+    Herd herd;
+    herd.cloneN(dolly, 3);
+    std::size_t firstShaun = herd.cloneN(shaun, 2);
+
+    herd.ageAll(1);
+    herd.recolor(firstShaun, "grey");
+    for (std::size_t i = 0; i < herd.size(); ++i)
+    {
+        herd.materialize(i)->speak();
+    }
+
+    // A population of five million from two prototypes: columns against unique_ptrs.
+    const std::size_t half = 2500000;
+    auto start = std::chrono::steady_clock::now();
+    Herd big;
+    big.cloneN(dolly, half);
+    big.cloneN(shaun, half);
+    double herdClone = millisSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<std::unique_ptr<Animal>> classic;
+    classic.reserve(2 * half);
+    for (std::size_t i = 0; i < half; ++i)
+        classic.push_back(dolly.clone());
+    for (std::size_t i = 0; i < half; ++i)
+        classic.push_back(shaun.clone());
+    double classicClone = millisSince(start);
+
+    std::uint32_t black = big.idOf("black");
+    start = std::chrono::steady_clock::now();
+    big.ageAll(1);
+    big.ageWhereColor(black, 1);
+    std::size_t herdBlack = big.countWithColor(black);
+    double herdOps = millisSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (auto &animal : classic)
+        *animal->year += 1;
+    for (auto &animal : classic)
+        *animal->year += animal->color == "black" ? 1 : 0;
+    std::size_t classicBlack = 0;
+    for (auto &animal : classic)
+        classicBlack += animal->color == "black";
+    double classicOps = millisSince(start);
+
+    bool same = herdBlack == classicBlack;
+    for (std::size_t i = 0; i < classic.size(); i += 9973)
+    {
+        same = same && big.year(i) == *classic[i]->year && big.color(i) == classic[i]->color;
+    }
+
+    std::cout << "Clone " << 2 * half << " animals: herd " << herdClone << " ms, unique_ptrs " << classicClone
+              << " ms" << std::endl;
+    std::cout << "Age all, age black, count black: herd " << herdOps << " ms, unique_ptrs " << classicOps
+              << " ms" << std::endl;
+    std::cout << "Results " << (same ? "match" : "DO NOT match") << std::endl;
+
+    return same ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+/*
+ * Prototype with Inline State Example
+ * -------------------------------------
+ * In prototype.cpp every Sheep::clone() allocates the object, a separate int for `year`
+ * and possibly both strings, and the default member initializer of Animal allocates a
+ * `year` that the copy constructor throws away again.
+ *
+ * Here the prototype's state is laid out so that copying it never allocates:
+ * - `year` is a plain int stored inside the object.
+ * - `name` and `color` are InternedString handles. Each distinct text is stored once in a
+ *   global table and never changes, so a handle is just a pointer and copying it is free.
+ * - clone() is therefore a flat copy: the only allocation is the new object itself, and a
+ *   Sheep copied by value (for example into a std::vector) allocates nothing at all.
+ *
+ * Interned texts live until the program ends, which suits a small set of shared values.
+ */
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include <mutex>
+#include <cstdlib>
+#include <new>
+#include <chrono>
+
+// Counts heap allocations made through the global operator new.
+static std::size_t heapAllocations = 0;
+
+void *operator new(std::size_t size)
+{
+    ++heapAllocations;
+    if (void *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// Immutable string shared by every handle with the same text.
+class InternedString
+{
+public:
+    InternedString() : text_(&intern("")) {}
+
+    // Implicit, so that `animal.color = "black"` works as with std::string.
+    InternedString(std::string_view text) : text_(&intern(text)) {}
+    InternedString(const char *text) : text_(&intern(text)) {}
+
+    const std::string &str() const
+    {
+        return *text_;
+    }
+
+    // Equal texts share one entry, so comparing handles compares the texts.
+    bool operator==(const InternedString &other) const
+    {
+        return text_ == other.text_;
+    }
+
+    bool operator!=(const InternedString &other) const
+    {
+        return text_ != other.text_;
+    }
+
+private:
+    const std::string *text_;
+
+    // Entries of an unordered_set never move, so pointers to them stay valid.
+    static const std::string &intern(std::string_view text)
+    {
+        static std::mutex mutex;
+        static std::unordered_set<std::string> table;
+        std::lock_guard<std::mutex> lock(mutex);
+        return *table.emplace(text).first;
+    }
+};
+
+std::ostream &operator<<(std::ostream &out, const InternedString &text)
+{
+    return out << text.str();
+}
+
+// Prototype
+class Animal
+{
+public:
+    InternedString name;
+    InternedString color;
+    int year = 0;
+    virtual std::unique_ptr<Animal> clone() const = 0;
+    virtual void speak() const = 0;
+    virtual ~Animal() = default;
+};
+
+// Concrete prototype
+class Sheep : public Animal
+{
+public:
+    Sheep(InternedString name, InternedString color)
+    {
+        this->name = name;
+        this->color = color;
+    }
+
+    // The implicit copy constructor copies two pointers and an int; no deep copy is needed.
+    std::unique_ptr<Animal> clone() const override
+    {
+        return std::make_unique<Sheep>(*this);
+    }
+
+    void speak() const override
+    {
+        std::cout << name << " the " << color << ", year: " << year << " sheep says: Baa!" << std::endl;
+    }
+};
+
+// The layout from prototype.cpp, for comparison.
+namespace classic
+{
+    class Animal
+    {
+    public:
+        std::string name;
+        std::string color;
+        std::unique_ptr<int> year = std::make_unique<int>();
+        virtual std::unique_ptr<Animal> clone() const = 0;
+        virtual ~Animal() = default;
+    };
+
+    class Sheep : public Animal
+    {
+    public:
+        Sheep(const std::string &name, const std::string &color)
+        {
+            this->name = name;
+            this->color = color;
+        }
+
+        Sheep(const Sheep &other)
+        {
+            name = other.name;
+            color = other.color;
+            year = std::make_unique<int>(*other.year);
+        }
+
+        std::unique_ptr<Animal> clone() const override
+        {
+            return std::make_unique<Sheep>(*this);
+        }
+    };
+}
+
+// Clones the prototype `count` times and returns the time per clone in nanoseconds.
+// The clones are kept alive so that allocation and release are both measured.
+template <typename Prototype>
+double benchmark(const Prototype &prototype, std::size_t count, std::size_t &allocationsPerClone)
+{
+    std::vector<decltype(prototype.clone())> herd;
+    herd.reserve(count);
+    std::size_t before = heapAllocations;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        herd.push_back(prototype.clone());
+    }
+    allocationsPerClone = (heapAllocations - before) / count;
+    herd.clear();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / count;
+}
+
+// Client
+int main()
+{
+    std::unique_ptr<Animal> orginal = std::make_unique<Sheep>("Dolly", "white");
+    orginal->year = 12;
+    orginal->speak(); // Dolly the white, year: 12 sheep says: Baa!
+
+    std::unique_ptr<Animal> clone1 = orginal->clone();
+    clone1->speak(); // Dolly the white, year: 12 sheep says: Baa!
+
+    orginal->color = "black";
+    orginal->year = 13;
+
+    std::unique_ptr<Animal> clone2 = orginal->clone();
+    clone1->speak(); // Dolly the white, year: 12 sheep says: Baa!
+    clone2->speak(); // Dolly the black, year: 13 sheep says: Baa!
+
+    // Allocation check. Texts longer than the small-string buffer make std::string allocate.
+    const char *longName = "Dolly of the Scottish Highlands";
+    const char *longColor = "white with a grey muzzle";
+    Sheep prototype(longName, longColor);
+    prototype.year = 7;
+    classic::Sheep classicPrototype(longName, longColor);
+    *classicPrototype.year = 7;
+
+    std::size_t before = heapAllocations;
+    auto flat = prototype.clone();
+    std::size_t cloneAllocations = heapAllocations - before;
+
+    before = heapAllocations;
+    Sheep byValue = prototype;
+    std::size_t copyAllocations = heapAllocations - before;
+
+    before = heapAllocations;
+    auto deep = classicPrototype.clone();
+    std::size_t classicAllocations = heapAllocations - before;
+
+    bool sameState = flat->name == prototype.name && flat->color == prototype.color && flat->year == 7 &&
+                     byValue.name == prototype.name && byValue.year == 7;
+    bool ok = sameState && cloneAllocations == 1 && copyAllocations == 0;
+    std::cout << "Heap allocations: classic clone " << classicAllocations << ", inline clone " << cloneAllocations
+              << ", copy by value " << copyAllocations << (ok ? "" : " (UNEXPECTED)") << std::endl;
+
+    // Clone throughput.
+    const std::size_t count = 1000000;
+    std::size_t classicPerClone = 0, inlinePerClone = 0;
+    double classicTime = benchmark(classicPrototype, count, classicPerClone);
+    double inlineTime = benchmark(prototype, count, inlinePerClone);
+    std::cout << "Classic clone: " << classicTime << " ns (" << classicPerClone << " allocations)" << std::endl;
+    std::cout << "Inline clone:  " << inlineTime << " ns (" << inlinePerClone << " allocation)" << std::endl;
+
+    return ok ? 0 : 1;
+}
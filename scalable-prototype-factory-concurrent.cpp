@@ -0,0 +1,420 @@
+/*
+ * Concurrent Scalable & Prototype Factory Example
+ * -------------------------------------------------
+ * In scalable-prototype-factory.cpp, registerFigure() and registerPrototype() write to a
+ * std::map that createFigure() reads without any synchronization. That is only safe if all
+ * registration happens before the first creation.
+ *
+ * Here both factories keep their registry as an immutable snapshot (read-copy-update):
+ * - createFigure() reads the current snapshot without taking any lock.
+ * - Registration copies the snapshot, adds the entry and publishes the copy atomically.
+ *   The old snapshot is freed once no creator can still be reading it.
+ *
+ * Registration therefore costs a copy of the registry, which suits plugins that register
+ * a handful of types while many threads create figures. Prototypes are held as
+ * shared_ptr<const Figure>, so snapshots can share them.
+ */
+
+#include <iostream>
+#include <memory>
+#include <map>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+
+// Base class for all Figures
+class Figure
+{
+public:
+    virtual void draw() const = 0;
+    // Virtual clone method for Prototype Factory
+    virtual std::unique_ptr<Figure> clone() const = 0;
+    virtual ~Figure() = default;
+};
+
+// Concrete class: Square
+class Square : public Figure
+{
+public:
+    void draw() const override
+    {
+        std::cout << "Drawing a Square" << std::endl;
+    }
+
+    std::unique_ptr<Figure> clone() const override
+    {
+        return std::make_unique<Square>(*this);
+    }
+};
+
+// Concrete class: Circle
+class Circle : public Figure
+{
+public:
+    void draw() const override
+    {
+        std::cout << "Drawing a Circle" << std::endl;
+    }
+    std::unique_ptr<Figure> clone() const override
+    {
+        return std::make_unique<Circle>(*this);
+    }
+};
+
+// Tracks the threads that are currently reading a snapshot.
+// Readers only increment and decrement a counter, writers wait for the counters to drain.
+// Counters are striped across cache lines so that reader threads do not fight over one line.
+class ReadEpoch
+{
+private:
+    static constexpr std::size_t kStripes = 16;
+
+    struct alignas(64) Counter
+    {
+        std::atomic<long> readers{0};
+    };
+
+    std::atomic<unsigned> epoch_{0};
+    Counter counters_[2][kStripes];
+
+    static std::size_t stripe()
+    {
+        static std::atomic<std::size_t> nextStripe{0};
+        thread_local std::size_t index = nextStripe.fetch_add(1) % kStripes;
+        return index;
+    }
+
+    void waitForReaders(unsigned epoch) const
+    {
+        for (const auto &counter : counters_[epoch])
+        {
+            while (counter.readers.load() != 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+public:
+    // Enter a read-side section, returns the token needed to leave it.
+    unsigned enter()
+    {
+        unsigned epoch = epoch_.load() & 1;
+        counters_[epoch][stripe()].readers.fetch_add(1);
+        return epoch;
+    }
+
+    void leave(unsigned epoch)
+    {
+        counters_[epoch][stripe()].readers.fetch_sub(1);
+    }
+
+    // Wait until every reader that entered before this call has left.
+    // Flipping twice guarantees that readers which picked either counter are covered.
+    void synchronize()
+    {
+        for (int phase = 0; phase < 2; ++phase)
+        {
+            unsigned previous = epoch_.fetch_add(1) & 1;
+            waitForReaders(previous);
+        }
+    }
+};
+
+// ID-to-value map published as immutable snapshots.
+template <typename Value>
+class SnapshotRegistry
+{
+public:
+    using Map = std::map<int, Value>;
+
+    SnapshotRegistry() : current_(new Map()) {}
+
+    SnapshotRegistry(const SnapshotRegistry &) = delete;
+    SnapshotRegistry &operator=(const SnapshotRegistry &) = delete;
+
+    ~SnapshotRegistry()
+    {
+        delete current_.load();
+    }
+
+    // Add an entry unless the ID is taken. Readers see either the old or the new snapshot.
+    bool add(int id, Value value)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        const Map *previous = current_.load();
+        if (previous->count(id))
+        {
+            return false;
+        }
+        auto next = new Map(*previous);
+        next->emplace(id, std::move(value));
+        current_.store(next);
+        readers_.synchronize();
+        delete previous;
+        return true;
+    }
+
+    // Call read(map) on the current snapshot. The snapshot stays valid until read returns.
+    // Safe to call from any number of threads at once.
+    template <typename Read>
+    auto read(Read read) const
+    {
+        struct Leave
+        {
+            ReadEpoch &readers;
+            unsigned epoch;
+            ~Leave() { readers.leave(epoch); }
+        } leave{readers_, readers_.enter()};
+        return read(*current_.load());
+    }
+
+private:
+    std::atomic<const Map *> current_;
+    mutable ReadEpoch readers_;
+    std::mutex writeMutex_; // Serializes writers only, readers never take it.
+};
+
+// -------------------------
+// Scalable Factory Pattern
+// -------------------------
+class ScalableFactory
+{
+public:
+    // Define the type for the function that creates a Figure object.
+    using CreateFigFun = std::function<std::unique_ptr<Figure>()>;
+
+    // Register a creation function for a given ID. May be called while other threads create.
+    bool registerFigure(int id, CreateFigFun func)
+    {
+        return _registry.add(id, std::move(func));
+    }
+
+    // Create a Figure object by its ID using the registered creation function.
+    std::unique_ptr<Figure> createFigure(int id) const
+    {
+        auto figure = _registry.read([id](const SnapshotRegistry<CreateFigFun>::Map &registry)
+                                     {
+                                         auto it = registry.find(id);
+                                         return it != registry.end() ? (it->second)() : nullptr; });
+        if (!figure)
+        {
+            std::cerr << "Unknown figure id: " << id << std::endl;
+        }
+        return figure;
+    }
+
+private:
+    SnapshotRegistry<CreateFigFun> _registry;
+};
+
+// -------------------------
+// Prototype Factory Pattern
+// -------------------------
+class PrototypeFactory
+{
+public:
+    // Register a prototype for a given ID. May be called while other threads create.
+    bool registerPrototype(int id, std::unique_ptr<Figure> prototype)
+    {
+        return _prototypes.add(id, std::shared_ptr<const Figure>(std::move(prototype)));
+    }
+
+    // Create a new Figure object by cloning the registered prototype.
+    std::unique_ptr<Figure> createFigure(int id) const
+    {
+        auto figure = _prototypes.read([id](const SnapshotRegistry<std::shared_ptr<const Figure>>::Map &prototypes)
+                                       {
+                                           auto it = prototypes.find(id);
+                                           return it != prototypes.end() ? it->second->clone() : nullptr; });
+        if (!figure)
+        {
+            std::cerr << "Unknown prototype id: " << id << std::endl;
+        }
+        return figure;
+    }
+
+private:
+    SnapshotRegistry<std::shared_ptr<const Figure>> _prototypes;
+};
+
+// Worker threads create figures of every ID registered so far while another thread keeps
+// registering new IDs. A creation for an ID whose registration has returned must succeed.
+bool stressTest(unsigned workerCount, int newIds)
+{
+    ScalableFactory scalableFactory;
+    PrototypeFactory prototypeFactory;
+    scalableFactory.registerFigure(0, []()
+                                   { return std::make_unique<Square>(); });
+    prototypeFactory.registerPrototype(0, std::make_unique<Circle>());
+    std::atomic<int> registered{1}; // IDs below this are registered in both factories.
+
+    std::atomic<bool> done{false};
+    std::atomic<long> failures{0}, created{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < workerCount; ++t)
+    {
+        workers.emplace_back([&, t]()
+                             {
+            unsigned seed = t + 1;
+            while (!done.load())
+            {
+                seed = seed * 1664525u + 1013904223u;
+                int id = static_cast<int>(seed % static_cast<unsigned>(registered.load()));
+                if (!scalableFactory.createFigure(id) || !prototypeFactory.createFigure(id))
+                {
+                    failures.fetch_add(1);
+                }
+                created.fetch_add(2, std::memory_order_relaxed);
+            } });
+    }
+
+    bool duplicatesRejected = true;
+    for (int id = 1; id <= newIds; ++id)
+    {
+        scalableFactory.registerFigure(id, id % 2 ? ScalableFactory::CreateFigFun([]()
+                                                                                 { return std::make_unique<Circle>(); })
+                                                  : ScalableFactory::CreateFigFun([]()
+                                                                                 { return std::make_unique<Square>(); }));
+        prototypeFactory.registerPrototype(id, std::make_unique<Square>());
+        duplicatesRejected = duplicatesRejected && !prototypeFactory.registerPrototype(id, std::make_unique<Circle>());
+        registered.store(id + 1);
+    }
+    done = true;
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    std::cout << "  " << created.load() << " figures created during " << newIds << " registrations, "
+              << failures.load() << " failures" << std::endl;
+    return failures.load() == 0 && duplicatesRejected;
+}
+
+// A map guarded by a mutex, the straightforward fix, for comparison.
+class LockedPrototypeFactory
+{
+public:
+    bool registerPrototype(int id, std::unique_ptr<Figure> prototype)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _prototypes.emplace(id, std::move(prototype)).second;
+    }
+
+    std::unique_ptr<Figure> createFigure(int id) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _prototypes.find(id);
+        return it != _prototypes.end() ? it->second->clone() : nullptr;
+    }
+
+private:
+    mutable std::mutex _mutex;
+    std::map<int, std::unique_ptr<Figure>> _prototypes;
+};
+
+// Creations per second for a growing number of threads, with one thread registering a new
+// prototype every 100 microseconds throughout the run.
+template <typename Factory>
+void benchmark(const char *name, unsigned maxThreads, int creationsPerThread)
+{
+    std::cout << name << ":" << std::endl;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        Factory factory;
+        for (int id = 0; id < 64; ++id)
+        {
+            factory.registerPrototype(id, std::make_unique<Square>());
+        }
+
+        std::atomic<bool> done{false};
+        std::thread registrar([&]()
+                              {
+            for (int id = 64; !done.load(); ++id)
+            {
+                factory.registerPrototype(id, std::make_unique<Circle>());
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            } });
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> creators;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            creators.emplace_back([&factory, creationsPerThread]()
+                                  {
+                for (int i = 0; i < creationsPerThread; ++i)
+                {
+                    factory.createFigure(i % 64);
+                } });
+        }
+        for (auto &creator : creators)
+        {
+            creator.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        done = true;
+        registrar.join();
+
+        double total = static_cast<double>(threads) * creationsPerThread;
+        std::cout << "  " << threads << " thread(s): " << static_cast<long>(total / elapsed.count())
+                  << " creations/s" << std::endl;
+    }
+}
+
+int main()
+{
+    // ---------- Scalable Factory Example ----------
+    ScalableFactory scalableFactory;
+    scalableFactory.registerFigure(1, []()
+                                   { return std::make_unique<Square>(); });
+    scalableFactory.registerFigure(2, []()
+                                   { return std::make_unique<Circle>(); });
+
+    std::cout << "Scalable Factory:" << std::endl;
+    auto fig1 = scalableFactory.createFigure(1);
+    if (fig1)
+        fig1->draw();
+    auto fig2 = scalableFactory.createFigure(2);
+    if (fig2)
+        fig2->draw();
+    auto fig3 = scalableFactory.createFigure(3);
+    if (fig3)
+        fig3->draw();
+
+    // ---------- Prototype Factory Example ----------
+    PrototypeFactory prototypefactory;
+
+    // Registering prototypes with unique_ptr
+    prototypefactory.registerPrototype(1, std::make_unique<Square>());
+    prototypefactory.registerPrototype(2, std::make_unique<Circle>());
+
+    std::cout << "Prototype Factory:" << std::endl;
+    auto figure1 = prototypefactory.createFigure(1);
+    if (figure1)
+        figure1->draw();
+
+    auto figure2 = prototypefactory.createFigure(2);
+    if (figure2)
+        figure2->draw();
+
+    // Attempt to create an object with an unknown ID
+    auto figure3 = prototypefactory.createFigure(3);
+    if (figure3)
+        figure3->draw();
+
+    // Stress test: creation from many threads during registration.
+    unsigned cores = std::max(2u, std::thread::hardware_concurrency());
+    std::cout << "Stress test:" << std::endl;
+    bool ok = stressTest(cores, 1000);
+    std::cout << "Stress test " << (ok ? "passed" : "FAILED") << std::endl;
+
+    // Benchmark: create throughput against the number of creator threads.
+    benchmark<PrototypeFactory>("Snapshot registry", cores, 500000);
+    benchmark<LockedPrototypeFactory>("Mutex-guarded map", cores, 500000);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,590 @@
+/*
+ * Dense-Registry Scalable & Prototype Factory Example
+ * -----------------------------------------------------
+ * The factories in scalable-prototype-factory.cpp find creators in a std::map, which walks
+ * a tree of nodes on every creation, and ScalableFactory calls through a std::function on
+ * top. When IDs are small integers, lookups can be much cheaper:
+ *
+ * 1. DenseRegistry:
+ *    - A plain array indexed by ID. A lookup is one bounds check and one load.
+ *    - Suited to dense IDs; the array is as long as the largest registered ID.
+ *
+ * 2. PerfectHashRegistry:
+ *    - For sparse IDs. Registration collects the entries, and freeze() builds a two-level
+ *      perfect hash (hash and displace): the IDs are hashed into small buckets, and each
+ *      bucket, largest first, gets a displacement that moves all of its IDs to free slots.
+ *    - The table has fewer than 2.5 slots per ID (a power of two at least 1.25 times the
+ *      number of IDs) plus one displacement per four IDs, and freeze() takes time roughly
+ *      linear in the number of IDs.
+ *    - After freeze() a lookup is one hash, one displacement load and one key comparison.
+ *
+ * Both factories take the registry type as a template parameter, and ScalableFactory stores
+ * creators as plain function pointers instead of std::function. Registering an ID twice
+ * behaves as in the map-based factories: ScalableFactory keeps the first creator and returns
+ * false, PrototypeFactory replaces the prototype.
+ */
+
+#include <iostream>
+#include <memory>
+#include <map>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <cstdint>
+#include <chrono>
+
+// Base class for all Figures
+class Figure
+{
+public:
+    virtual void draw() const = 0;
+    // Virtual clone method for Prototype Factory
+    virtual std::unique_ptr<Figure> clone() const = 0;
+    virtual ~Figure() = default;
+};
+
+// Concrete class: Square
+class Square : public Figure
+{
+public:
+    void draw() const override
+    {
+        std::cout << "Drawing a Square" << std::endl;
+    }
+
+    std::unique_ptr<Figure> clone() const override
+    {
+        return std::make_unique<Square>(*this);
+    }
+};
+
+// Concrete class: Circle
+class Circle : public Figure
+{
+public:
+    void draw() const override
+    {
+        std::cout << "Drawing a Circle" << std::endl;
+    }
+    std::unique_ptr<Figure> clone() const override
+    {
+        return std::make_unique<Circle>(*this);
+    }
+};
+
+// -------------------------
+// Registries
+// -------------------------
+
+// Array indexed by ID. Value must be default-constructible to an empty state testable with `!`.
+template <typename Value>
+class DenseRegistry
+{
+public:
+    // IDs above this are rejected instead of growing the array without bound.
+    static constexpr int kMaxId = 1 << 16;
+
+    // An ID that is already registered keeps its value unless `replace` is set.
+    bool add(int id, Value value, bool replace)
+    {
+        if (id < 0 || id > kMaxId || !value)
+        {
+            return false;
+        }
+        if (static_cast<std::size_t>(id) >= _slots.size())
+        {
+            _slots.resize(static_cast<std::size_t>(id) + 1);
+        }
+        if (_slots[id] && !replace)
+        {
+            return false;
+        }
+        _slots[id] = std::move(value);
+        return true;
+    }
+
+    // Nothing to prepare; present so both registries can be used the same way.
+    void freeze() {}
+
+    // The registered value, or an empty one for unknown IDs.
+    const Value &find(int id) const
+    {
+        if (static_cast<std::size_t>(id) < _slots.size())
+        {
+            return _slots[id];
+        }
+        return _empty;
+    }
+
+private:
+    std::vector<Value> _slots;
+    Value _empty{};
+};
+
+// Collision-free hash table built once registration is finished.
+template <typename Value>
+class PerfectHashRegistry
+{
+public:
+    // Registration is only possible before freeze(). An ID that is already registered keeps
+    // its value unless `replace` is set.
+    bool add(int id, Value value, bool replace)
+    {
+        if (_frozen || !value)
+        {
+            return false;
+        }
+        auto known = _index.find(id);
+        if (known != _index.end())
+        {
+            if (!replace)
+            {
+                return false;
+            }
+            _pending[known->second].value = std::move(value);
+            return true;
+        }
+        _index.emplace(id, _pending.size());
+        _pending.push_back(Entry{id, std::move(value)});
+        return true;
+    }
+
+    // Build the table. Tries new seeds until every bucket finds a displacement, which
+    // usually succeeds with the first one.
+    void freeze()
+    {
+        if (_frozen)
+        {
+            return;
+        }
+        if (!_pending.empty())
+        {
+            std::mt19937_64 random(0x9e3779b97f4a7c15ull);
+            do
+            {
+                _seed = random();
+            } while (!tryBuild());
+        }
+        _pending.clear();
+        _index.clear();
+        _frozen = true;
+    }
+
+    // The registered value, or an empty one for unknown IDs. Requires freeze().
+    const Value &find(int id) const
+    {
+        std::uint64_t hash = hashOf(id);
+        const Entry &entry = _table[slotOf(hash, _displacements[bucketOf(hash)])];
+        return entry.id == id ? entry.value : _empty;
+    }
+
+    std::size_t tableSize() const
+    {
+        return _table.size();
+    }
+
+private:
+    struct Entry
+    {
+        int id = 0;
+        Value value{};
+    };
+
+    static constexpr std::size_t kBucketSize = 4; // Average IDs per bucket.
+
+    std::vector<Entry> _pending;
+    std::unordered_map<int, std::size_t> _index; // ID -> position in _pending.
+    std::vector<Entry> _table = std::vector<Entry>(1); // A single empty slot until frozen.
+    std::vector<std::uint32_t> _displacements = std::vector<std::uint32_t>(1);
+    std::uint64_t _seed = 0;
+    std::uint64_t _mask = 0;
+    bool _frozen = false;
+    Value _empty{};
+
+    // Different IDs always get different hashes: every step is invertible.
+    std::uint64_t hashOf(int id) const
+    {
+        std::uint64_t x = static_cast<std::uint32_t>(id) + _seed;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    std::size_t bucketOf(std::uint64_t hash) const
+    {
+        return static_cast<std::size_t>(((hash >> 32) * _displacements.size()) >> 32);
+    }
+
+    // The step is odd and the table size a power of two, so the displacements of a single
+    // ID reach every slot.
+    std::size_t slotOf(std::uint64_t hash, std::uint32_t displacement) const
+    {
+        std::uint64_t step = (hash >> 32) | 1;
+        return static_cast<std::size_t>((hash + displacement * step) & _mask);
+    }
+
+    bool tryBuild()
+    {
+        std::size_t count = _pending.size();
+        std::size_t slots = 1;
+        while (slots < count + count / 4)
+        {
+            slots *= 2;
+        }
+        _mask = slots - 1;
+        _displacements.assign((count + kBucketSize - 1) / kBucketSize, 0);
+
+        // Group the entries by bucket (counting sort), then place the largest buckets first.
+        std::vector<std::uint64_t> hashes(count);
+        std::vector<std::size_t> bucketStart(_displacements.size() + 1, 0);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            hashes[i] = hashOf(_pending[i].id);
+            ++bucketStart[bucketOf(hashes[i]) + 1];
+        }
+        for (std::size_t b = 0; b < _displacements.size(); ++b)
+        {
+            bucketStart[b + 1] += bucketStart[b];
+        }
+        std::vector<std::size_t> members(count), next(bucketStart.begin(), bucketStart.end() - 1);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            members[next[bucketOf(hashes[i])]++] = i;
+        }
+        std::vector<std::size_t> order(_displacements.size());
+        for (std::size_t b = 0; b < order.size(); ++b)
+        {
+            order[b] = b;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+                         { return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b]; });
+
+        std::vector<bool> used(slots);
+        std::vector<std::size_t> slotOfEntry(count), placed;
+        const std::uint64_t maxDisplacement = 4 * static_cast<std::uint64_t>(slots);
+        for (std::size_t bucket : order)
+        {
+            std::size_t first = bucketStart[bucket], last = bucketStart[bucket + 1];
+            if (first == last)
+            {
+                break; // The remaining buckets are empty too.
+            }
+            bool fits = false;
+            for (std::uint64_t d = 0; d < maxDisplacement && !fits; ++d)
+            {
+                placed.clear();
+                fits = true;
+                for (std::size_t m = first; m < last && fits; ++m)
+                {
+                    std::size_t slot = slotOf(hashes[members[m]], static_cast<std::uint32_t>(d));
+                    fits = !used[slot];
+                    if (fits)
+                    {
+                        used[slot] = true; // Also catches two IDs of this bucket in one slot.
+                        placed.push_back(slot);
+                        slotOfEntry[members[m]] = slot;
+                    }
+                }
+                for (std::size_t slot : placed)
+                {
+                    used[slot] = fits;
+                }
+                if (fits)
+                {
+                    _displacements[bucket] = static_cast<std::uint32_t>(d);
+                }
+            }
+            if (!fits)
+            {
+                return false;
+            }
+        }
+
+        std::vector<Entry> table(slots);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            table[slotOfEntry[i]] = std::move(_pending[i]);
+        }
+        _table = std::move(table);
+        return true;
+    }
+};
+
+// -------------------------
+// Scalable Factory Pattern
+// -------------------------
+template <template <typename> class Registry>
+class ScalableFactory
+{
+public:
+    // Plain function pointer: no std::function call and no captured state.
+    using CreateFigFun = std::unique_ptr<Figure> (*)();
+
+    // Register a creation function for a given ID.
+    // An ID that is already registered keeps its first creator, as with the map's emplace().
+    bool registerFigure(int id, CreateFigFun func)
+    {
+        return _registry.add(id, func, false);
+    }
+
+    // Finish registration (required for PerfectHashRegistry).
+    void freeze()
+    {
+        _registry.freeze();
+    }
+
+    // Create a Figure object by its ID using the registered creation function.
+    std::unique_ptr<Figure> createFigure(int id) const
+    {
+        if (CreateFigFun func = _registry.find(id))
+        {
+            return func();
+        }
+        std::cerr << "Unknown figure id: " << id << std::endl;
+        return nullptr;
+    }
+
+private:
+    Registry<CreateFigFun> _registry;
+};
+
+// Creation function for any default-constructible figure.
+template <typename ConcreteFigure>
+std::unique_ptr<Figure> makeFigure()
+{
+    return std::make_unique<ConcreteFigure>();
+}
+
+// -------------------------
+// Prototype Factory Pattern
+// -------------------------
+template <template <typename> class Registry>
+class PrototypeFactory
+{
+public:
+    // Register a prototype for a given ID, replacing an earlier one as the map version does.
+    bool registerPrototype(int id, std::unique_ptr<Figure> prototype)
+    {
+        return _prototypes.add(id, std::move(prototype), true);
+    }
+
+    // Finish registration (required for PerfectHashRegistry).
+    void freeze()
+    {
+        _prototypes.freeze();
+    }
+
+    // Create a new Figure object by cloning the registered prototype.
+    std::unique_ptr<Figure> createFigure(int id) const
+    {
+        if (const auto &prototype = _prototypes.find(id))
+        {
+            return prototype->clone();
+        }
+        std::cerr << "Unknown prototype id: " << id << std::endl;
+        return nullptr;
+    }
+
+private:
+    Registry<std::unique_ptr<Figure>> _prototypes;
+};
+
+// The map-based factories from scalable-prototype-factory.cpp, for comparison.
+namespace classic
+{
+    class ScalableFactory
+    {
+    public:
+        using CreateFigFun = std::function<std::unique_ptr<Figure>()>;
+
+        bool registerFigure(int id, CreateFigFun func)
+        {
+            return _registry.emplace(id, func).second;
+        }
+
+        std::unique_ptr<Figure> cretateFigure(int id)
+        {
+            auto it = _registry.find(id);
+            if (it != _registry.end())
+            {
+                return (it->second)();
+            }
+            std::cerr << "Unknow figure id: " << id << std::endl;
+            return nullptr;
+        }
+
+    private:
+        std::map<int, CreateFigFun> _registry;
+    };
+
+    class PrototypeFactory
+    {
+    public:
+        bool registerPrototype(int id, std::unique_ptr<Figure> prototype)
+        {
+            _prototypes[id] = std::move(prototype);
+            return true;
+        }
+
+        std::unique_ptr<Figure> createFigure(int id)
+        {
+            auto it = _prototypes.find(id);
+            if (it != _prototypes.end())
+            {
+                return it->second->clone();
+            }
+            std::cerr << "Unknown prototype id: " << id << std::endl;
+            return nullptr;
+        }
+
+    private:
+        std::map<int, std::unique_ptr<Figure>> _prototypes;
+    };
+}
+
+// Creates one figure per ID in `ids` and returns the time per creation in nanoseconds.
+template <typename Create>
+double benchmark(const std::vector<int> &ids, Create create)
+{
+    std::size_t created = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int id : ids)
+    {
+        std::unique_ptr<Figure> figure = create(id);
+        created += figure != nullptr;
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if (created != ids.size())
+    {
+        std::cerr << "Benchmark created only " << created << " figures" << std::endl;
+    }
+    return elapsed.count() / ids.size();
+}
+
+int main()
+{
+    // ---------- Scalable Factory Example ----------
+    ScalableFactory<DenseRegistry> scalableFactory;
+    scalableFactory.registerFigure(1, makeFigure<Square>);
+    scalableFactory.registerFigure(2, []() -> std::unique_ptr<Figure>
+                                   { return std::make_unique<Circle>(); });
+
+    std::cout << "Scalable Factory:" << std::endl;
+    auto fig1 = scalableFactory.createFigure(1);
+    if (fig1)
+        fig1->draw();
+    auto fig2 = scalableFactory.createFigure(2);
+    if (fig2)
+        fig2->draw();
+    auto fig3 = scalableFactory.createFigure(3);
+    if (fig3)
+        fig3->draw();
+
+    // ---------- Prototype Factory Example ----------
+    // Sparse IDs, so the perfect hash is used.
+    PrototypeFactory<PerfectHashRegistry> prototypefactory;
+    prototypefactory.registerPrototype(1001, std::make_unique<Square>());
+    prototypefactory.registerPrototype(70000, std::make_unique<Circle>());
+    prototypefactory.freeze();
+
+    std::cout << "Prototype Factory:" << std::endl;
+    auto figure1 = prototypefactory.createFigure(1001);
+    if (figure1)
+        figure1->draw();
+
+    auto figure2 = prototypefactory.createFigure(70000);
+    if (figure2)
+        figure2->draw();
+
+    // Attempt to create an object with an unknown ID
+    auto figure3 = prototypefactory.createFigure(3);
+    if (figure3)
+        figure3->draw();
+
+    // ---------- Creation throughput ----------
+    // 256 registered IDs (dense for the array, spread out for the perfect hash) and
+    // ten million creations in random order.
+    const int types = 256;
+    classic::ScalableFactory mapScalable;
+    classic::PrototypeFactory mapPrototype;
+    ScalableFactory<DenseRegistry> denseScalable;
+    PrototypeFactory<DenseRegistry> densePrototype;
+    ScalableFactory<PerfectHashRegistry> hashScalable;
+    PrototypeFactory<PerfectHashRegistry> hashPrototype;
+    for (int id = 0; id < types; ++id)
+    {
+        bool square = id % 2 == 0;
+        mapScalable.registerFigure(id, square ? classic::ScalableFactory::CreateFigFun(makeFigure<Square>)
+                                              : classic::ScalableFactory::CreateFigFun(makeFigure<Circle>));
+        mapPrototype.registerPrototype(id, square ? makeFigure<Square>() : makeFigure<Circle>());
+        denseScalable.registerFigure(id, square ? makeFigure<Square> : makeFigure<Circle>);
+        densePrototype.registerPrototype(id, square ? makeFigure<Square>() : makeFigure<Circle>());
+        hashScalable.registerFigure(id * 7919, square ? makeFigure<Square> : makeFigure<Circle>);
+        hashPrototype.registerPrototype(id * 7919, square ? makeFigure<Square>() : makeFigure<Circle>());
+    }
+    hashScalable.freeze();
+    hashPrototype.freeze();
+
+    std::vector<int> ids(10000000), sparseIds(ids.size());
+    std::mt19937 random(42);
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+        ids[i] = static_cast<int>(random() % types);
+        sparseIds[i] = ids[i] * 7919;
+    }
+
+    std::cout << "Creation time per figure:" << std::endl;
+    std::cout << "  map + std::function ScalableFactory: "
+              << benchmark(ids, [&](int id)
+                           { return mapScalable.cretateFigure(id); })
+              << " ns" << std::endl;
+    std::cout << "  map PrototypeFactory:                "
+              << benchmark(ids, [&](int id)
+                           { return mapPrototype.createFigure(id); })
+              << " ns" << std::endl;
+    std::cout << "  dense ScalableFactory:               "
+              << benchmark(ids, [&](int id)
+                           { return denseScalable.createFigure(id); })
+              << " ns" << std::endl;
+    std::cout << "  dense PrototypeFactory:              "
+              << benchmark(ids, [&](int id)
+                           { return densePrototype.createFigure(id); })
+              << " ns" << std::endl;
+    std::cout << "  perfect-hash ScalableFactory:        "
+              << benchmark(sparseIds, [&](int id)
+                           { return hashScalable.createFigure(id); })
+              << " ns" << std::endl;
+    std::cout << "  perfect-hash PrototypeFactory:       "
+              << benchmark(sparseIds, [&](int id)
+                           { return hashPrototype.createFigure(id); })
+              << " ns" << std::endl;
+
+    // Freezing random sparse IDs: table size and time should grow linearly.
+    bool allFound = true;
+    for (std::size_t count : {1024, 16384, 262144})
+    {
+        using CreateFigFun = ScalableFactory<PerfectHashRegistry>::CreateFigFun;
+        PerfectHashRegistry<CreateFigFun> registry;
+        std::vector<int> registered;
+        std::mt19937 idRandom(static_cast<unsigned>(count));
+        while (registered.size() < count)
+        {
+            int id = static_cast<int>(idRandom() >> 1);
+            if (registry.add(id, makeFigure<Square>, false))
+                registered.push_back(id);
+        }
+        auto start = std::chrono::steady_clock::now();
+        registry.freeze();
+        std::chrono::duration<double, std::milli> freezeTime = std::chrono::steady_clock::now() - start;
+        for (int id : registered)
+            allFound = allFound && registry.find(id) == makeFigure<Square>;
+        allFound = allFound && !registry.find(-1);
+        std::cout << "Perfect hash over " << count << " random IDs: freeze " << freezeTime.count() << " ms, "
+                  << registry.tableSize() << " slots" << std::endl;
+    }
+    std::cout << "Perfect-hash lookups " << (allFound ? "correct" : "WRONG") << std::endl;
+
+    return allFound ? 0 : 1;
+}
@@ -0,0 +1,490 @@
+/*
+ * Pooled Prototype Factory Example
+ * ----------------------------------
+ * PrototypeFactory::createFigure() clones a prototype with std::make_unique, so every figure
+ * costs one heap allocation and one free. This example removes that churn in two ways:
+ *
+ * 1. Pooled figures:
+ *    - A figure class derives from PooledFigure<Self>, which gives it a class-specific
+ *      operator new/delete backed by a free list of blocks of exactly that class's size.
+ *    - The public type stays std::unique_ptr<Figure>: deleting through the virtual
+ *      destructor calls the concrete class's operator delete, which puts the block back on
+ *      its free list. Blocks are reused by the next clone of that type.
+ *    - PooledFigure also implements clone() for the class, so a pooled figure only
+ *      defines its own behaviour.
+ *
+ * 2. Bulk creation:
+ *    - createFigures(id, n) makes one allocation large enough for n figures and clones the
+ *      prototype n times into it, side by side. The FigureBatch owns the storage and
+ *      destroys the figures together.
+ *
+ * The pools are not thread-safe: pooled figures must be created and destroyed on one thread.
+ */
+
+#include <iostream>
+#include <memory>
+#include <map>
+#include <vector>
+#include <new>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdlib>
+#include <chrono>
+
+// Counts heap allocations made through the global operator new.
+static std::size_t heapAllocations = 0;
+
+void *operator new(std::size_t size)
+{
+    ++heapAllocations;
+    if (void *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// Base class for all Figures
+class Figure
+{
+public:
+    virtual void draw() const = 0;
+    // Virtual clone method for Prototype Factory
+    virtual std::unique_ptr<Figure> clone() const = 0;
+    // Size and alignment of the concrete object, and an in-place copy for bulk creation.
+    virtual std::size_t objectSize() const = 0;
+    virtual std::size_t objectAlignment() const = 0;
+    virtual Figure *cloneAt(void *memory) const = 0;
+    virtual ~Figure() = default;
+};
+
+// Fixed-size blocks carved out of larger chunks. Freed blocks are kept for reuse and the
+// chunks are only returned when the pool itself is destroyed.
+class FreeList
+{
+private:
+    struct Block
+    {
+        Block *next;
+    };
+
+    static constexpr std::size_t kBlocksPerChunk = 256;
+
+    std::size_t blockSize_;
+    Block *free_ = nullptr;
+    std::vector<void *> chunks_;
+
+    void grow()
+    {
+        char *chunk = static_cast<char *>(::operator new(blockSize_ * kBlocksPerChunk));
+        chunks_.push_back(chunk);
+        for (std::size_t i = kBlocksPerChunk; i-- > 0;)
+        {
+            Block *block = reinterpret_cast<Block *>(chunk + i * blockSize_);
+            block->next = free_;
+            free_ = block;
+        }
+    }
+
+public:
+    // Blocks are aligned like the chunk, i.e. for any fundamental type.
+    explicit FreeList(std::size_t size)
+        : blockSize_((std::max(size, sizeof(Block)) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) *
+                     alignof(std::max_align_t))
+    {
+    }
+
+    FreeList(const FreeList &) = delete;
+    FreeList &operator=(const FreeList &) = delete;
+
+    ~FreeList()
+    {
+        for (void *chunk : chunks_)
+        {
+            ::operator delete(chunk);
+        }
+    }
+
+    void *allocate()
+    {
+        if (!free_)
+        {
+            grow();
+        }
+        Block *block = free_;
+        free_ = block->next;
+        return block;
+    }
+
+    void release(void *memory)
+    {
+        Block *block = static_cast<Block *>(memory);
+        block->next = free_;
+        free_ = block;
+    }
+
+    std::size_t chunks() const
+    {
+        return chunks_.size();
+    }
+};
+
+// Base for figures allocated from a per-type pool. ConcreteFigure must derive from it directly.
+template <typename ConcreteFigure>
+class PooledFigure : public Figure
+{
+public:
+    static void *operator new(std::size_t size)
+    {
+        if (size != sizeof(ConcreteFigure))
+        {
+            return ::operator new(size); // A further derived class; not pooled.
+        }
+        return pool().allocate();
+    }
+
+    static void operator delete(void *memory, std::size_t size)
+    {
+        if (size != sizeof(ConcreteFigure))
+        {
+            ::operator delete(memory);
+            return;
+        }
+        pool().release(memory);
+    }
+
+    std::unique_ptr<Figure> clone() const override
+    {
+        return std::make_unique<ConcreteFigure>(static_cast<const ConcreteFigure &>(*this));
+    }
+
+    std::size_t objectSize() const override
+    {
+        return sizeof(ConcreteFigure);
+    }
+
+    std::size_t objectAlignment() const override
+    {
+        return alignof(ConcreteFigure);
+    }
+
+    Figure *cloneAt(void *memory) const override
+    {
+        return ::new (memory) ConcreteFigure(static_cast<const ConcreteFigure &>(*this));
+    }
+
+    static FreeList &pool()
+    {
+        static FreeList freeList(sizeof(ConcreteFigure));
+        return freeList;
+    }
+};
+
+// Concrete class: Square
+class Square : public PooledFigure<Square>
+{
+public:
+    explicit Square(double side = 1.0) : side_(side) {}
+
+    void draw() const override
+    {
+        std::cout << "Drawing a Square with side " << side_ << std::endl;
+    }
+
+private:
+    double side_;
+};
+
+// Concrete class: Circle
+class Circle : public PooledFigure<Circle>
+{
+public:
+    explicit Circle(double radius = 1.0) : radius_(radius) {}
+
+    void draw() const override
+    {
+        std::cout << "Drawing a Circle with radius " << radius_ << std::endl;
+    }
+
+private:
+    double radius_;
+};
+
+// Figures created together in one allocation. All of them are clones of one prototype.
+class FigureBatch
+{
+public:
+    FigureBatch() = default;
+
+    // Figures with extended alignment are not supported.
+    FigureBatch(const Figure &prototype, std::size_t count)
+        : stride_((prototype.objectSize() + prototype.objectAlignment() - 1) / prototype.objectAlignment() *
+                  prototype.objectAlignment())
+    {
+        if (prototype.objectAlignment() > alignof(std::max_align_t))
+        {
+            throw std::invalid_argument("FigureBatch: over-aligned figure type");
+        }
+        if (count == 0)
+        {
+            return;
+        }
+        storage_ = static_cast<char *>(::operator new(stride_ * count));
+        try
+        {
+            for (; count_ < count; ++count_)
+            {
+                char *object = storage_ + count_ * stride_;
+                Figure *figure = prototype.cloneAt(object);
+                if (count_ == 0)
+                {
+                    // The Figure base need not sit at the start of the concrete object.
+                    offset_ = static_cast<std::size_t>(reinterpret_cast<char *>(figure) - object);
+                }
+            }
+        }
+        catch (...)
+        {
+            clear();
+            throw;
+        }
+    }
+
+    FigureBatch(FigureBatch &&other) noexcept
+        : storage_(other.storage_), stride_(other.stride_), offset_(other.offset_), count_(other.count_)
+    {
+        other.storage_ = nullptr;
+        other.count_ = 0;
+    }
+
+    FigureBatch &operator=(FigureBatch &&other) noexcept
+    {
+        if (this != &other)
+        {
+            clear();
+            std::swap(storage_, other.storage_);
+            std::swap(count_, other.count_);
+            stride_ = other.stride_;
+            offset_ = other.offset_;
+        }
+        return *this;
+    }
+
+    ~FigureBatch()
+    {
+        clear();
+    }
+
+    Figure &operator[](std::size_t index) const
+    {
+        return *std::launder(reinterpret_cast<Figure *>(storage_ + index * stride_ + offset_));
+    }
+
+    std::size_t size() const
+    {
+        return count_;
+    }
+
+private:
+    char *storage_ = nullptr;
+    std::size_t stride_ = 0;
+    std::size_t offset_ = 0; // Of the Figure base within each object, as cloneAt() returned it.
+    std::size_t count_ = 0;
+
+    // Destroy the figures in place; the storage is freed as a whole.
+    void clear()
+    {
+        for (std::size_t i = count_; i-- > 0;)
+        {
+            (*this)[i].~Figure();
+        }
+        if (storage_)
+        {
+            ::operator delete(storage_);
+        }
+        storage_ = nullptr;
+        count_ = 0;
+    }
+};
+
+// -------------------------
+// Prototype Factory Pattern
+// -------------------------
+class PrototypeFactory
+{
+public:
+    // Register a prototype for a given ID.
+    bool registerPrototype(int id, std::unique_ptr<Figure> prototype)
+    {
+        _prototypes[id] = std::move(prototype);
+        return true;
+    }
+
+    // Create a new Figure object by cloning the registered prototype.
+    std::unique_ptr<Figure> createFigure(int id)
+    {
+        auto it = _prototypes.find(id);
+        if (it != _prototypes.end())
+        {
+            return it->second->clone();
+        }
+        std::cerr << "Unknown prototype id: " << id << std::endl;
+        return nullptr;
+    }
+
+    // Create n clones of the registered prototype in one contiguous allocation.
+    FigureBatch createFigures(int id, std::size_t n)
+    {
+        auto it = _prototypes.find(id);
+        if (it != _prototypes.end())
+        {
+            return FigureBatch(*it->second, n);
+        }
+        std::cerr << "Unknown prototype id: " << id << std::endl;
+        return FigureBatch();
+    }
+
+private:
+    std::map<int, std::unique_ptr<Figure>> _prototypes;
+};
+
+// Figures allocated with plain make_unique, for comparison.
+namespace classic
+{
+    class Square : public Figure
+    {
+    public:
+        void draw() const override {}
+        std::unique_ptr<Figure> clone() const override { return std::make_unique<Square>(*this); }
+        std::size_t objectSize() const override { return sizeof(Square); }
+        std::size_t objectAlignment() const override { return alignof(Square); }
+        Figure *cloneAt(void *memory) const override { return ::new (memory) Square(*this); }
+
+    private:
+        double side_ = 1.0;
+    };
+}
+
+// A figure whose Figure base does not start at the beginning of the object.
+class Labeled
+{
+public:
+    virtual ~Labeled() = default;
+    int label = 7;
+};
+
+class LabeledCircle : public Labeled, public Figure
+{
+public:
+    void draw() const override { std::cout << "Drawing Circle labeled " << label << std::endl; }
+    std::unique_ptr<Figure> clone() const override { return std::make_unique<LabeledCircle>(*this); }
+    std::size_t objectSize() const override { return sizeof(LabeledCircle); }
+    std::size_t objectAlignment() const override { return alignof(LabeledCircle); }
+    Figure *cloneAt(void *memory) const override { return ::new (memory) LabeledCircle(*this); }
+};
+
+double nanosSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    PrototypeFactory prototypefactory;
+
+    // Registering prototypes with unique_ptr
+    prototypefactory.registerPrototype(1, std::make_unique<Square>(2.0));
+    prototypefactory.registerPrototype(2, std::make_unique<Circle>(0.5));
+    prototypefactory.registerPrototype(3, std::make_unique<classic::Square>());
+
+    std::cout << "Prototype Factory:" << std::endl;
+    auto figure1 = prototypefactory.createFigure(1);
+    if (figure1)
+        figure1->draw();
+
+    auto figure2 = prototypefactory.createFigure(2);
+    if (figure2)
+        figure2->draw();
+
+    // Attempt to create an object with an unknown ID
+    auto figure4 = prototypefactory.createFigure(4);
+    if (figure4)
+        figure4->draw();
+
+    // A released figure returns to its pool and the next clone reuses the block.
+    Figure *released = figure1.get();
+    figure1.reset();
+    figure1 = prototypefactory.createFigure(1);
+    std::cout << "Released block reused: " << (figure1.get() == released ? "yes" : "no") << std::endl;
+
+    FigureBatch batch = prototypefactory.createFigures(2, 3);
+    for (std::size_t i = 0; i < batch.size(); ++i)
+        batch[i].draw();
+
+    prototypefactory.registerPrototype(4, std::make_unique<LabeledCircle>());
+    FigureBatch labeled = prototypefactory.createFigures(4, 2);
+    labeled[1].draw();
+    bool labeledOk = dynamic_cast<LabeledCircle *>(&labeled[1]) != nullptr;
+
+    // Create-and-release churn: one million figures alive at a time, recycled several rounds.
+    const std::size_t live = 1000000;
+    const int rounds = 5;
+    std::vector<std::unique_ptr<Figure>> figures(live);
+    bool allReused = true;
+    for (int id : {3, 1})
+    {
+        for (auto &figure : figures)
+            figure = prototypefactory.createFigure(id); // Warm-up: fills the pool.
+        std::size_t allocationsBefore = heapAllocations;
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round)
+        {
+            for (auto &figure : figures)
+            {
+                figure.reset();
+                figure = prototypefactory.createFigure(id);
+            }
+        }
+        double perFigure = nanosSince(start) / (live * rounds);
+        std::size_t allocations = heapAllocations - allocationsBefore;
+        if (id == 1)
+            allReused = allReused && allocations == 0;
+        std::cout << (id == 3 ? "make_unique clones: " : "pooled clones:      ") << perFigure
+                  << " ns/figure, " << allocations << " heap allocations" << std::endl;
+    }
+    figures.clear();
+
+    // Bulk creation against one clone at a time.
+    std::size_t allocationsBefore = heapAllocations;
+    auto start = std::chrono::steady_clock::now();
+    FigureBatch bulk = prototypefactory.createFigures(3, live);
+    double bulkTime = nanosSince(start) / live;
+    std::size_t bulkAllocations = heapAllocations - allocationsBefore;
+    allReused = allReused && bulkAllocations == 1;
+
+    allocationsBefore = heapAllocations;
+    start = std::chrono::steady_clock::now();
+    figures.resize(live);
+    for (auto &figure : figures)
+        figure = prototypefactory.createFigure(3);
+    double singleTime = nanosSince(start) / live;
+    std::size_t singleAllocations = heapAllocations - allocationsBefore;
+
+    std::cout << "createFigures(id, " << live << "): " << bulkTime << " ns/figure, " << bulkAllocations
+              << " heap allocation(s)" << std::endl;
+    std::cout << "createFigure(id) x " << live << ":  " << singleTime << " ns/figure, " << singleAllocations
+              << " heap allocations" << std::endl;
+
+    return allReused && labeledOk ? 0 : 1;
+}
@@ -0,0 +1,360 @@
+/*
+ * Batch Visitor Example
+ * -----------------------
+ * In visitor.cpp the elements of different types are interleaved behind pointers, so every
+ * visit is an indirect call whose target changes unpredictably from one element to the next.
+ *
+ * ElementStore keeps each concrete element type in its own contiguous array:
+ * - acceptBatched() hands the visitor one Span per type. A visitor that overrides the batch
+ *   visit() runs a plain loop over a homogeneous array, which the compiler can unroll and
+ *   auto-vectorize.
+ * - acceptInOrder() still visits the elements one by one in insertion order, for visitors
+ *   whose result depends on that order.
+ * - Visitors that only implement the single-element visit() work with both, because the
+ *   default batch visit() loops over the single-element one.
+ */
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <chrono>
+
+// Minimal non-owning view of a contiguous array (std::span is C++20).
+template <typename T>
+class Span
+{
+public:
+    Span(T *data, std::size_t size) : data_(data), size_(size) {}
+
+    T *begin() const { return data_; }
+    T *end() const { return data_ + size_; }
+    std::size_t size() const { return size_; }
+    T &operator[](std::size_t index) const { return data_[index]; }
+
+private:
+    T *data_;
+    std::size_t size_;
+};
+
+// Concrete elements hold their data directly, so an array of them is an array of values.
+class ConcreteElementA
+{
+public:
+    explicit ConcreteElementA(float value = 1.0f) : value(value) {}
+
+    // Specific operation for ConcreteElementA.
+    void operationA()
+    {
+        std::cout << "ConcreteElementA: operationA" << std::endl;
+    }
+
+    float value;
+};
+
+class ConcreteElementB
+{
+public:
+    explicit ConcreteElementB(float weight = 2.0f) : weight(weight) {}
+
+    // Specific operation for ConcreteElementB.
+    void operationB()
+    {
+        std::cout << "ConcreteElementB: operationB" << std::endl;
+    }
+
+    float weight;
+};
+
+// Visitor interface with single-element and batch entry points.
+class Visitor
+{
+public:
+    virtual void visit(ConcreteElementA &element) = 0;
+    virtual void visit(ConcreteElementB &element) = 0;
+
+    // Batch entry points. Override them to process a whole homogeneous run in one loop.
+    virtual void visit(Span<ConcreteElementA> elements)
+    {
+        for (ConcreteElementA &element : elements)
+        {
+            visit(element);
+        }
+    }
+
+    virtual void visit(Span<ConcreteElementB> elements)
+    {
+        for (ConcreteElementB &element : elements)
+        {
+            visit(element);
+        }
+    }
+
+    virtual ~Visitor() = default;
+};
+
+// Elements partitioned by type, with their insertion order remembered.
+class ElementStore
+{
+private:
+    enum class Type : std::uint8_t
+    {
+        A,
+        B
+    };
+
+    struct Entry
+    {
+        Type type;
+        std::uint32_t index;
+    };
+
+    std::vector<ConcreteElementA> as_;
+    std::vector<ConcreteElementB> bs_;
+    std::vector<Entry> order_;
+
+public:
+    void add(const ConcreteElementA &element)
+    {
+        order_.push_back(Entry{Type::A, static_cast<std::uint32_t>(as_.size())});
+        as_.push_back(element);
+    }
+
+    void add(const ConcreteElementB &element)
+    {
+        order_.push_back(Entry{Type::B, static_cast<std::uint32_t>(bs_.size())});
+        bs_.push_back(element);
+    }
+
+    void reserve(std::size_t count)
+    {
+        order_.reserve(count);
+    }
+
+    // Visit every A, then every B, one batch per type.
+    void acceptBatched(Visitor &visitor)
+    {
+        visitor.visit(Span<ConcreteElementA>(as_.data(), as_.size()));
+        visitor.visit(Span<ConcreteElementB>(bs_.data(), bs_.size()));
+    }
+
+    // Visit the elements one at a time in the order they were added.
+    void acceptInOrder(Visitor &visitor)
+    {
+        for (const Entry &entry : order_)
+        {
+            if (entry.type == Type::A)
+                visitor.visit(as_[entry.index]);
+            else
+                visitor.visit(bs_[entry.index]);
+        }
+    }
+
+    std::size_t size() const
+    {
+        return order_.size();
+    }
+};
+
+// Concrete Visitor that implements operations for each concrete element.
+class ConcreteVisitor : public Visitor
+{
+public:
+    using Visitor::visit;
+
+    void visit(ConcreteElementA &element) override
+    {
+        std::cout << "ConcreteVisitor: Visiting ConcreteElementA." << std::endl;
+        element.operationA();
+    }
+
+    void visit(ConcreteElementB &element) override
+    {
+        std::cout << "ConcreteVisitor: Visiting ConcreteElementB." << std::endl;
+        element.operationB();
+    }
+};
+
+// Visitor with batch overrides: scales every A and shifts every B.
+class TransformVisitor : public Visitor
+{
+public:
+    using Visitor::visit;
+
+    void visit(ConcreteElementA &element) override
+    {
+        element.value *= 1.5f;
+    }
+
+    void visit(ConcreteElementB &element) override
+    {
+        element.weight += 0.25f;
+    }
+
+    void visit(Span<ConcreteElementA> elements) override
+    {
+        ConcreteElementA *data = elements.begin();
+        for (std::size_t i = 0; i < elements.size(); ++i)
+        {
+            data[i].value *= 1.5f;
+        }
+    }
+
+    void visit(Span<ConcreteElementB> elements) override
+    {
+        ConcreteElementB *data = elements.begin();
+        for (std::size_t i = 0; i < elements.size(); ++i)
+        {
+            data[i].weight += 0.25f;
+        }
+    }
+};
+
+// The classic pointer-based engine from visitor.cpp, for comparison.
+namespace classic
+{
+    class ConcreteElementA;
+    class ConcreteElementB;
+
+    class Visitor
+    {
+    public:
+        virtual void visit(ConcreteElementA &element) = 0;
+        virtual void visit(ConcreteElementB &element) = 0;
+        virtual ~Visitor() = default;
+    };
+
+    class Element
+    {
+    public:
+        virtual void accept(Visitor &visitor) = 0;
+        virtual ~Element() = default;
+    };
+
+    class ConcreteElementA : public Element
+    {
+    public:
+        explicit ConcreteElementA(float value) : value(value) {}
+        void accept(Visitor &visitor) override { visitor.visit(*this); }
+        float value;
+    };
+
+    class ConcreteElementB : public Element
+    {
+    public:
+        explicit ConcreteElementB(float weight) : weight(weight) {}
+        void accept(Visitor &visitor) override { visitor.visit(*this); }
+        float weight;
+    };
+
+    class TransformVisitor : public Visitor
+    {
+    public:
+        void visit(ConcreteElementA &element) override { element.value *= 1.5f; }
+        void visit(ConcreteElementB &element) override { element.weight += 0.25f; }
+    };
+}
+
+// Sums the data of every element, in insertion order.
+class ChecksumVisitor : public Visitor
+{
+public:
+    using Visitor::visit;
+
+    void visit(ConcreteElementA &element) override { sum += element.value; }
+    void visit(ConcreteElementB &element) override { sum += element.weight; }
+
+    double sum = 0;
+};
+
+double millisSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Client
+int main()
+{
+    ElementStore store;
+    store.add(ConcreteElementA());
+    store.add(ConcreteElementB());
+
+    ConcreteVisitor visitor;
+    store.acceptInOrder(visitor);
+    store.acceptBatched(visitor);
+
+    // Ten million interleaved elements, transformed repeatedly by each engine.
+    const std::size_t count = 10000000;
+    const int passes = 5;
+    ElementStore inOrder, batched;
+    std::vector<std::unique_ptr<classic::Element>> pointers;
+    inOrder.reserve(count);
+    batched.reserve(count);
+    pointers.reserve(count);
+    std::uint32_t seed = 11;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        float data = static_cast<float>(i % 7);
+        if (seed >> 31)
+        {
+            inOrder.add(ConcreteElementA(data));
+            batched.add(ConcreteElementA(data));
+            pointers.push_back(std::make_unique<classic::ConcreteElementA>(data));
+        }
+        else
+        {
+            inOrder.add(ConcreteElementB(data));
+            batched.add(ConcreteElementB(data));
+            pointers.push_back(std::make_unique<classic::ConcreteElementB>(data));
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    classic::TransformVisitor classicTransform;
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        for (auto &element : pointers)
+        {
+            element->accept(classicTransform);
+        }
+    }
+    double classicTime = millisSince(start);
+
+    TransformVisitor transform;
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        inOrder.acceptInOrder(transform);
+    }
+    double inOrderTime = millisSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        batched.acceptBatched(transform);
+    }
+    double batchedTime = millisSince(start);
+
+    ChecksumVisitor inOrderSum, batchedSum;
+    inOrder.acceptInOrder(inOrderSum);
+    batched.acceptInOrder(batchedSum);
+    double classicSum = 0;
+    for (auto &element : pointers)
+    {
+        if (auto a = dynamic_cast<classic::ConcreteElementA *>(element.get()))
+            classicSum += a->value;
+        else
+            classicSum += static_cast<classic::ConcreteElementB *>(element.get())->weight;
+    }
+
+    double perElement = 1e6 / (static_cast<double>(count) * passes);
+    std::cout << "Classic pointers, interleaved: " << classicTime * perElement << " ns/element" << std::endl;
+    std::cout << "Partitioned, insertion order:  " << inOrderTime * perElement << " ns/element" << std::endl;
+    std::cout << "Partitioned, batched:          " << batchedTime * perElement << " ns/element" << std::endl;
+
+    bool same = classicSum == inOrderSum.sum && inOrderSum.sum == batchedSum.sum;
+    std::cout << "Results " << (same ? "match" : "DO NOT match") << std::endl;
+
+    return same ? 0 : 1;
+}
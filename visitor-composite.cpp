@@ -0,0 +1,383 @@
+/*
+ * Fused Visitor over Composite Example
+ * --------------------------------------
+ * Elements form a composite tree: CompositeElement holds child elements, and
+ * ConcreteElementA / ConcreteElementB are the leaves. Running several visitors over the
+ * tree one after another walks the whole pointer structure once per visitor.
+ *
+ * FusedTraversal runs any number of visitors (up to 64) in one walk:
+ * - Every node is loaded once and handed to each visitor that is still interested in it.
+ * - Before descending into a composite, each active visitor is asked enter(); a visitor that
+ *   returns false is pruned from that subtree. The walk tracks the interested visitors as a
+ *   bit mask and skips a subtree entirely once the mask is empty.
+ * - leave() is called on the visitors that entered, after the subtree is done.
+ *
+ * Visitors are applied in registration order at every node, so each visitor sees exactly
+ * the same sequence of calls as it would in a walk of its own.
+ */
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <chrono>
+
+// Forward declarations of element classes.
+class ConcreteElementA;
+class ConcreteElementB;
+class CompositeElement;
+
+// Visitor interface declaring visit methods for each leaf, and enter/leave for composites.
+class Visitor
+{
+public:
+    virtual void visit(ConcreteElementA &element) = 0;
+    virtual void visit(ConcreteElementB &element) = 0;
+
+    // Return false to skip the composite's subtree for this visitor.
+    virtual bool enter(CompositeElement &)
+    {
+        return true;
+    }
+
+    virtual void leave(CompositeElement &) {}
+
+    virtual ~Visitor() = default;
+};
+
+// Element interface, with an accept method that accepts a visitor.
+class Element
+{
+public:
+    virtual void accept(Visitor &visitor) = 0;
+
+    // Non-null for composites, so traversals need no dynamic_cast.
+    virtual CompositeElement *asComposite()
+    {
+        return nullptr;
+    }
+
+    virtual ~Element() = default;
+};
+
+// Concrete Element A.
+class ConcreteElementA : public Element
+{
+public:
+    explicit ConcreteElementA(int value = 1) : value_(value) {}
+
+    void accept(Visitor &visitor) override
+    {
+        visitor.visit(*this);
+    }
+
+    int value() const { return value_; }
+
+private:
+    int value_;
+};
+
+// Concrete Element B.
+class ConcreteElementB : public Element
+{
+public:
+    explicit ConcreteElementB(int weight = 2) : weight_(weight) {}
+
+    void accept(Visitor &visitor) override
+    {
+        visitor.visit(*this);
+    }
+
+    int weight() const { return weight_; }
+
+private:
+    int weight_;
+};
+
+// Composite element. Keeps a few facts about its subtree that visitors can prune on.
+class CompositeElement : public Element
+{
+public:
+    explicit CompositeElement(bool visible = true) : visible_(visible) {}
+
+    // Children may be added in any order, also to a composite that already has a parent:
+    // the B count is passed up to every ancestor.
+    void add(std::unique_ptr<Element> element)
+    {
+        std::size_t addedB = 0;
+        if (CompositeElement *composite = element->asComposite())
+        {
+            composite->parent_ = this;
+            addedB = composite->countB_;
+        }
+        else if (dynamic_cast<ConcreteElementB *>(element.get()))
+        {
+            addedB = 1;
+        }
+        for (CompositeElement *node = this; node && addedB > 0; node = node->parent_)
+        {
+            node->countB_ += addedB;
+        }
+        children_.push_back(std::move(element));
+    }
+
+    // Single-visitor traversal, the way the visitor would walk the tree on its own.
+    void accept(Visitor &visitor) override
+    {
+        if (!visitor.enter(*this))
+        {
+            return;
+        }
+        for (auto &child : children_)
+        {
+            child->accept(visitor);
+        }
+        visitor.leave(*this);
+    }
+
+    CompositeElement *asComposite() override
+    {
+        return this;
+    }
+
+    const std::vector<std::unique_ptr<Element>> &children() const { return children_; }
+    bool visible() const { return visible_; }
+    // Number of ConcreteElementB leaves in the subtree, kept up to date as children are added.
+    std::size_t countB() const { return countB_; }
+
+private:
+    std::vector<std::unique_ptr<Element>> children_;
+    CompositeElement *parent_ = nullptr;
+    bool visible_;
+    std::size_t countB_ = 0;
+};
+
+// Runs several visitors over a tree in one walk.
+class FusedTraversal
+{
+public:
+    using Mask = std::uint64_t;
+
+    void add(Visitor &visitor)
+    {
+        if (visitors_.size() == 64)
+        {
+            throw std::length_error("FusedTraversal supports at most 64 visitors");
+        }
+        visitors_.push_back(&visitor);
+    }
+
+    void run(Element &root)
+    {
+        if (!visitors_.empty())
+        {
+            walk(root, visitors_.size() == 64 ? ~Mask(0) : (Mask(1) << visitors_.size()) - 1);
+        }
+    }
+
+private:
+    std::vector<Visitor *> visitors_;
+
+    void walk(Element &element, Mask active)
+    {
+        CompositeElement *composite = element.asComposite();
+        if (!composite)
+        {
+            for (std::size_t i = 0; i < visitors_.size(); ++i)
+            {
+                if (active >> i & 1)
+                {
+                    element.accept(*visitors_[i]);
+                }
+            }
+            return;
+        }
+
+        Mask entered = 0;
+        for (std::size_t i = 0; i < visitors_.size(); ++i)
+        {
+            if ((active >> i & 1) && visitors_[i]->enter(*composite))
+            {
+                entered |= Mask(1) << i;
+            }
+        }
+        if (!entered)
+        {
+            return;
+        }
+        for (auto &child : composite->children())
+        {
+            walk(*child, entered);
+        }
+        for (std::size_t i = 0; i < visitors_.size(); ++i)
+        {
+            if (entered >> i & 1)
+            {
+                visitors_[i]->leave(*composite);
+            }
+        }
+    }
+};
+
+// Concrete Visitor that implements operations for each concrete element.
+class ConcreteVisitor : public Visitor
+{
+public:
+    void visit(ConcreteElementA &) override
+    {
+        std::cout << "ConcreteVisitor: Visiting ConcreteElementA." << std::endl;
+    }
+
+    void visit(ConcreteElementB &) override
+    {
+        std::cout << "ConcreteVisitor: Visiting ConcreteElementB." << std::endl;
+    }
+
+    bool enter(CompositeElement &) override
+    {
+        std::cout << "ConcreteVisitor: Entering CompositeElement." << std::endl;
+        return true;
+    }
+};
+
+// Visits everything and sums the A values.
+class SumAVisitor : public Visitor
+{
+public:
+    void visit(ConcreteElementA &element) override { sum += element.value(); }
+    void visit(ConcreteElementB &) override {}
+
+    std::int64_t sum = 0;
+};
+
+// Only interested in B, so it skips subtrees without any.
+class MaxBVisitor : public Visitor
+{
+public:
+    void visit(ConcreteElementA &) override {}
+    void visit(ConcreteElementB &element) override { max = std::max(max, element.weight()); }
+    bool enter(CompositeElement &composite) override { return composite.countB() > 0; }
+
+    int max = 0;
+};
+
+// Counts the leaves under visible composites only.
+class VisibleCountVisitor : public Visitor
+{
+public:
+    void visit(ConcreteElementA &) override { ++count; }
+    void visit(ConcreteElementB &) override { ++count; }
+    bool enter(CompositeElement &composite) override { return composite.visible(); }
+
+    std::size_t count = 0;
+};
+
+// Tracks the deepest level reached, using enter/leave.
+class DepthVisitor : public Visitor
+{
+public:
+    void visit(ConcreteElementA &) override {}
+    void visit(ConcreteElementB &) override {}
+
+    bool enter(CompositeElement &) override
+    {
+        maxDepth = std::max(maxDepth, ++depth);
+        return true;
+    }
+
+    void leave(CompositeElement &) override { --depth; }
+
+    int depth = 0, maxDepth = 0;
+};
+
+// A tree with `fanout` children per composite and `depth` levels of composites. Some
+// composites are hidden and some hold only A leaves, so the pruning visitors skip them.
+std::unique_ptr<CompositeElement> buildTree(int fanout, int depth, std::uint32_t &seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    bool onlyA = (seed >> 28) == 0;
+    auto composite = std::make_unique<CompositeElement>((seed >> 24 & 7) != 0);
+    for (int i = 0; i < fanout; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        int data = static_cast<int>(seed >> 22);
+        if (depth > 1)
+            composite->add(buildTree(fanout, depth - 1, seed));
+        else if (onlyA || (seed >> 31))
+            composite->add(std::make_unique<ConcreteElementA>(data));
+        else
+            composite->add(std::make_unique<ConcreteElementB>(data));
+    }
+    return composite;
+}
+
+double millisSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    // Create a small tree of elements.
+    auto inner = std::make_unique<CompositeElement>();
+    inner->add(std::make_unique<ConcreteElementA>());
+    inner->add(std::make_unique<ConcreteElementB>());
+    CompositeElement root;
+    root.add(std::move(inner));
+    root.add(std::make_unique<ConcreteElementA>());
+
+    ConcreteVisitor visitor;
+    root.accept(visitor);
+
+    // A composite filled after it was added to its parent still counts towards the parent,
+    // so MaxBVisitor does not prune it.
+    CompositeElement topDown;
+    auto branch = std::make_unique<CompositeElement>();
+    CompositeElement *branchPtr = branch.get();
+    topDown.add(std::move(branch));
+    branchPtr->add(std::make_unique<ConcreteElementB>(42));
+    MaxBVisitor topDownMaxB;
+    topDown.accept(topDownMaxB);
+    bool topDownOk = topDown.countB() == 1 && topDownMaxB.max == 42;
+    std::cout << "Tree built top-down: max B " << topDownMaxB.max << (topDownOk ? "" : " (WRONG)") << std::endl;
+
+    // Four analyses over a tree of about two million leaves: one walk each, then one fused walk.
+    std::uint32_t seed = 9;
+    auto tree = buildTree(8, 7, seed);
+
+    SumAVisitor sumA;
+    MaxBVisitor maxB;
+    VisibleCountVisitor visible;
+    DepthVisitor depth;
+    auto start = std::chrono::steady_clock::now();
+    tree->accept(sumA);
+    tree->accept(maxB);
+    tree->accept(visible);
+    tree->accept(depth);
+    double separateTime = millisSince(start);
+
+    SumAVisitor fusedSumA;
+    MaxBVisitor fusedMaxB;
+    VisibleCountVisitor fusedVisible;
+    DepthVisitor fusedDepth;
+    FusedTraversal fused;
+    fused.add(fusedSumA);
+    fused.add(fusedMaxB);
+    fused.add(fusedVisible);
+    fused.add(fusedDepth);
+    start = std::chrono::steady_clock::now();
+    fused.run(*tree);
+    double fusedTime = millisSince(start);
+
+    bool same = sumA.sum == fusedSumA.sum && maxB.max == fusedMaxB.max && visible.count == fusedVisible.count &&
+                depth.maxDepth == fusedDepth.maxDepth && fusedDepth.depth == 0;
+
+    std::cout << "Sum of A " << fusedSumA.sum << ", max B " << fusedMaxB.max << ", visible leaves "
+              << fusedVisible.count << ", depth " << fusedDepth.maxDepth << std::endl;
+    std::cout << "Four separate walks: " << separateTime << " ms, one fused walk: " << fusedTime << " ms" << std::endl;
+    std::cout << "Fused results " << (same ? "match" : "DO NOT match") << " the separate walks" << std::endl;
+
+    return same && topDownOk ? 0 : 1;
+}
@@ -0,0 +1,360 @@
+/*
+ * Parallel Visitor Example
+ * --------------------------
+ * A visitor that computes an aggregate (counts, sums, extremes) over a large collection visits
+ * the elements one after another on a single thread. Such analyses can run as a map-reduce:
+ * - parallelVisit() cuts the collection into chunks and runs them on a thread pool.
+ * - Every chunk is visited by its own copy of the visitor, so the visitors keep their
+ *   accumulators without any locking.
+ * - A user-supplied merge function folds the copies together in chunk order, so the result
+ *   does not depend on which thread finished first.
+ *
+ * The visitor must only read the elements; the elements must not change during the visit.
+ */
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+
+// Forward declarations of concrete element classes.
+class ConcreteElementA;
+class ConcreteElementB;
+
+// Visitor interface declaring visit methods for each concrete element.
+class Visitor
+{
+public:
+    virtual void visit(ConcreteElementA &element) = 0;
+    virtual void visit(ConcreteElementB &element) = 0;
+    virtual ~Visitor() = default;
+};
+
+// Element interface, with an accept method that accepts a visitor.
+class Element
+{
+public:
+    virtual void accept(Visitor &visitor) = 0;
+    virtual ~Element() = default;
+};
+
+// Concrete Element A.
+class ConcreteElementA : public Element
+{
+public:
+    explicit ConcreteElementA(int value = 1) : value_(value) {}
+
+    void accept(Visitor &visitor) override
+    {
+        visitor.visit(*this);
+    }
+
+    int value() const { return value_; }
+
+private:
+    int value_;
+};
+
+// Concrete Element B.
+class ConcreteElementB : public Element
+{
+public:
+    explicit ConcreteElementB(int weight = 2) : weight_(weight) {}
+
+    void accept(Visitor &visitor) override
+    {
+        visitor.visit(*this);
+    }
+
+    int weight() const { return weight_; }
+
+private:
+    int weight_;
+};
+
+// Concrete Visitor collecting statistics over the elements.
+class StatisticsVisitor : public Visitor
+{
+public:
+    void visit(ConcreteElementA &element) override
+    {
+        ++countA;
+        sumA += element.value();
+        maxA = std::max(maxA, element.value());
+    }
+
+    void visit(ConcreteElementB &element) override
+    {
+        ++countB;
+        sumB += element.weight();
+        minB = std::min(minB, element.weight());
+    }
+
+    // Fold the statistics of another part of the collection into these.
+    void merge(const StatisticsVisitor &other)
+    {
+        countA += other.countA;
+        countB += other.countB;
+        sumA += other.sumA;
+        sumB += other.sumB;
+        maxA = std::max(maxA, other.maxA);
+        minB = std::min(minB, other.minB);
+    }
+
+    bool operator==(const StatisticsVisitor &other) const
+    {
+        return countA == other.countA && countB == other.countB && sumA == other.sumA && sumB == other.sumB &&
+               maxA == other.maxA && minB == other.minB;
+    }
+
+    std::size_t countA = 0, countB = 0;
+    std::int64_t sumA = 0, sumB = 0;
+    int maxA = std::numeric_limits<int>::min();
+    int minB = std::numeric_limits<int>::max();
+};
+
+// Statistics visitor that refuses negative values.
+class CheckedVisitor : public StatisticsVisitor
+{
+public:
+    using StatisticsVisitor::visit;
+
+    void visit(ConcreteElementA &element) override
+    {
+        if (element.value() < 0)
+        {
+            throw std::invalid_argument("negative value");
+        }
+        StatisticsVisitor::visit(element);
+    }
+};
+
+// Fixed-size pool of threads taking tasks from a shared queue.
+class ThreadPool
+{
+private:
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    bool stopping_ = false;
+
+    void workerLoop()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this]
+                            { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+    explicit ThreadPool(unsigned threads)
+    {
+        threads = std::max(1u, threads);
+        for (unsigned i = 0; i < threads; ++i)
+        {
+            threads_.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Finishes the queued tasks before the threads exit.
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        ready_.notify_all();
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    std::future<void> submit(std::function<void()> function)
+    {
+        auto task = std::make_shared<std::packaged_task<void()>>(std::move(function));
+        std::future<void> done = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back([task]
+                             { (*task)(); });
+        }
+        ready_.notify_one();
+        return done;
+    }
+
+    std::size_t size() const
+    {
+        return threads_.size();
+    }
+};
+
+// Visit every element in parallel. Each chunk gets a copy of `prototype`; the copies are
+// combined in chunk order with merge(into, from) and the combined visitor is returned.
+// Every chunk starts from the prototype, so it should be an empty visitor (the identity of
+// merge); any state it carries would be counted once per chunk.
+// If a chunk throws, the first exception is rethrown once every chunk has finished.
+template <typename ConcreteVisitor, typename Merge>
+ConcreteVisitor parallelVisit(std::vector<std::unique_ptr<Element>> &elements, const ConcreteVisitor &prototype,
+                              ThreadPool &pool, Merge merge)
+{
+    // A few chunks per thread, so a slow chunk does not leave the other threads idle.
+    std::size_t chunks = std::min(elements.size(), pool.size() * 4);
+    if (chunks == 0)
+    {
+        return prototype;
+    }
+
+    // Each copy gets its own cache line, so threads updating neighbouring copies do not
+    // keep invalidating each other's caches.
+    struct alignas(64) Partial
+    {
+        ConcreteVisitor visitor;
+    };
+    std::vector<Partial> partial(chunks, Partial{prototype});
+    std::vector<std::future<void>> done;
+    done.reserve(chunks);
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        std::size_t begin = elements.size() * chunk / chunks;
+        std::size_t end = elements.size() * (chunk + 1) / chunks;
+        ConcreteVisitor *visitor = &partial[chunk].visitor;
+        done.push_back(pool.submit([&elements, visitor, begin, end]
+                                   {
+                                       for (std::size_t i = begin; i < end; ++i)
+                                       {
+                                           elements[i]->accept(*visitor);
+                                       } }));
+    }
+
+    // The tasks write into `partial`, so all of them must finish before it goes away.
+    std::exception_ptr failure;
+    for (auto &chunk : done)
+    {
+        try
+        {
+            chunk.get();
+        }
+        catch (...)
+        {
+            if (!failure)
+            {
+                failure = std::current_exception();
+            }
+        }
+    }
+    if (failure)
+    {
+        std::rethrow_exception(failure);
+    }
+
+    ConcreteVisitor result = std::move(partial[0].visitor);
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk)
+    {
+        merge(result, partial[chunk].visitor);
+    }
+    return result;
+}
+
+double millisSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    // Ten million interleaved elements.
+    const std::size_t count = 10000000;
+    std::vector<std::unique_ptr<Element>> elements;
+    elements.reserve(count);
+    std::uint32_t seed = 3;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        int data = static_cast<int>(seed >> 20);
+        if (seed >> 31)
+            elements.push_back(std::make_unique<ConcreteElementA>(data));
+        else
+            elements.push_back(std::make_unique<ConcreteElementB>(data));
+    }
+
+    auto merge = [](StatisticsVisitor &into, const StatisticsVisitor &from)
+    { into.merge(from); };
+
+    // Serial reference result.
+    auto start = std::chrono::steady_clock::now();
+    StatisticsVisitor serial;
+    for (auto &e : elements)
+    {
+        e->accept(serial);
+    }
+    double serialTime = millisSince(start);
+    std::cout << "Serial visit: " << serialTime << " ms (" << serial.countA << " A, " << serial.countB
+              << " B, sum A " << serial.sumA << ", max A " << serial.maxA << ", min B " << serial.minB << ")" << std::endl;
+
+    bool allMatch = true;
+    unsigned maxThreads = std::max(4u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        ThreadPool pool(threads);
+        start = std::chrono::steady_clock::now();
+        StatisticsVisitor parallel = parallelVisit(elements, StatisticsVisitor(), pool, merge);
+        double elapsed = millisSince(start);
+        bool match = parallel == serial;
+        allMatch = allMatch && match;
+        std::cout << "  " << threads << " thread(s): " << elapsed << " ms, speed-up " << serialTime / elapsed
+                  << ", result " << (match ? "matches serial" : "DIFFERS from serial") << std::endl;
+    }
+
+    // Edge cases: an empty collection and fewer elements than chunks.
+    ThreadPool pool(4);
+    std::vector<std::unique_ptr<Element>> few;
+    bool emptyOk = parallelVisit(few, StatisticsVisitor(), pool, merge) == StatisticsVisitor();
+    few.push_back(std::make_unique<ConcreteElementA>(5));
+    few.push_back(std::make_unique<ConcreteElementB>(7));
+    StatisticsVisitor fewStats = parallelVisit(few, StatisticsVisitor(), pool, merge);
+    bool fewOk = fewStats.countA == 1 && fewStats.countB == 1 && fewStats.maxA == 5 && fewStats.minB == 7;
+
+    // A failing chunk is reported after the other chunks have finished.
+    few.push_back(std::make_unique<ConcreteElementA>(-1));
+    bool thrown = false;
+    try
+    {
+        parallelVisit(few, CheckedVisitor(), pool, [](CheckedVisitor &into, const CheckedVisitor &from)
+                      { into.merge(from); });
+    }
+    catch (const std::invalid_argument &)
+    {
+        thrown = true;
+    }
+    std::cout << "Edge cases " << (emptyOk && fewOk && thrown ? "pass" : "FAIL") << std::endl;
+
+    return allMatch && emptyOk && fewOk && thrown ? 0 : 1;
+}
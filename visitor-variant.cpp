@@ -0,0 +1,281 @@
+/*
+ * Variant-Based Visitor Example
+ * -------------------------------
+ * The classic Visitor stores every element behind a pointer and costs two virtual calls per
+ * visit (accept, then visit). When the set of element types is closed, std::variant gives
+ * the same separation of algorithms from elements with static dispatch:
+ * - Elements are stored by value, one after another, in a std::vector<std::variant<...>>.
+ * - A visitor is any callable with an overload per element type; std::visit picks the
+ *   overload from the variant's index, and the compiler can inline the visitor body.
+ * - An overload set of lambdas can serve as a visitor without declaring a class.
+ *
+ * Adding a new element type means changing the variant and every visitor, exactly as with
+ * the classic Visitor. The benchmark compares both engines over ten million elements and
+ * reports cache misses through perf_event_open on Linux when the kernel allows it.
+ */
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <variant>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// Concrete elements are plain value types; they do not derive from a common base.
+class ConcreteElementA
+{
+public:
+    explicit ConcreteElementA(int value = 1) : value_(value) {}
+
+    // Specific operation for ConcreteElementA.
+    void operationA() const
+    {
+        std::cout << "ConcreteElementA: operationA" << std::endl;
+    }
+
+    int value() const { return value_; }
+
+private:
+    int value_;
+};
+
+class ConcreteElementB
+{
+public:
+    explicit ConcreteElementB(int weight = 2) : weight_(weight) {}
+
+    // Specific operation for ConcreteElementB.
+    void operationB() const
+    {
+        std::cout << "ConcreteElementB: operationB" << std::endl;
+    }
+
+    int weight() const { return weight_; }
+
+private:
+    int weight_;
+};
+
+// The closed set of element types.
+using Element = std::variant<ConcreteElementA, ConcreteElementB>;
+
+// Combines several lambdas into one overloaded callable.
+template <typename... Visitors>
+struct Overloaded : Visitors...
+{
+    using Visitors::operator()...;
+};
+template <typename... Visitors>
+Overloaded(Visitors...) -> Overloaded<Visitors...>;
+
+// Apply a visitor to every element in storage order.
+template <typename Visitor>
+void visitAll(const std::vector<Element> &elements, Visitor &&visitor)
+{
+    for (const Element &element : elements)
+    {
+        std::visit(visitor, element);
+    }
+}
+
+// Concrete visitor: one operator() per element type, no virtual functions.
+class ConcreteVisitor
+{
+public:
+    void operator()(const ConcreteElementA &element) const
+    {
+        std::cout << "ConcreteVisitor: Visiting ConcreteElementA." << std::endl;
+        element.operationA();
+    }
+
+    void operator()(const ConcreteElementB &element) const
+    {
+        std::cout << "ConcreteVisitor: Visiting ConcreteElementB." << std::endl;
+        element.operationB();
+    }
+};
+
+// The classic double-dispatch engine from visitor.cpp, with the same data, for comparison.
+namespace classic
+{
+    class ConcreteElementA;
+    class ConcreteElementB;
+
+    class Visitor
+    {
+    public:
+        virtual void visit(ConcreteElementA &element) = 0;
+        virtual void visit(ConcreteElementB &element) = 0;
+        virtual ~Visitor() = default;
+    };
+
+    class Element
+    {
+    public:
+        virtual void accept(Visitor &visitor) = 0;
+        virtual ~Element() = default;
+    };
+
+    class ConcreteElementA : public Element
+    {
+    public:
+        explicit ConcreteElementA(int value) : value_(value) {}
+        void accept(Visitor &visitor) override { visitor.visit(*this); }
+        int value() const { return value_; }
+
+    private:
+        int value_;
+    };
+
+    class ConcreteElementB : public Element
+    {
+    public:
+        explicit ConcreteElementB(int weight) : weight_(weight) {}
+        void accept(Visitor &visitor) override { visitor.visit(*this); }
+        int weight() const { return weight_; }
+
+    private:
+        int weight_;
+    };
+
+    class SumVisitor : public Visitor
+    {
+    public:
+        void visit(ConcreteElementA &element) override { sum += element.value(); }
+        void visit(ConcreteElementB &element) override { sum += 3 * element.weight(); }
+
+        std::int64_t sum = 0;
+    };
+}
+
+// Counts last-level cache misses of the calling thread, if the kernel permits it.
+class CacheMissCounter
+{
+private:
+    int fd_ = -1;
+
+public:
+    CacheMissCounter()
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    CacheMissCounter(const CacheMissCounter &) = delete;
+    CacheMissCounter &operator=(const CacheMissCounter &) = delete;
+
+    ~CacheMissCounter()
+    {
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+        }
+    }
+
+    void start()
+    {
+        if (fd_ >= 0)
+        {
+            ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    // Misses since start(), or "n/a" when hardware counters are unavailable.
+    std::string stop()
+    {
+        if (fd_ < 0)
+        {
+            return "n/a";
+        }
+        ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        long long misses = 0;
+        if (::read(fd_, &misses, sizeof(misses)) != sizeof(misses))
+        {
+            return "n/a";
+        }
+        return std::to_string(misses);
+    }
+};
+
+// Client
+int main()
+{
+    std::vector<Element> elements;
+    elements.emplace_back(ConcreteElementA());
+    elements.emplace_back(ConcreteElementB());
+
+    visitAll(elements, ConcreteVisitor());
+
+    // The same visit written as an overload set of lambdas.
+    visitAll(elements, Overloaded{
+                           [](const ConcreteElementA &element) { element.operationA(); },
+                           [](const ConcreteElementB &element) { element.operationB(); },
+                       });
+
+    // Both engines over ten million interleaved elements, summing a value per element.
+    const std::size_t count = 10000000;
+    std::vector<Element> values;
+    std::vector<std::unique_ptr<classic::Element>> pointers;
+    values.reserve(count);
+    pointers.reserve(count);
+    std::uint32_t seed = 7;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        int data = static_cast<int>(i % 100);
+        if (seed >> 31)
+        {
+            values.emplace_back(ConcreteElementA(data));
+            pointers.push_back(std::make_unique<classic::ConcreteElementA>(data));
+        }
+        else
+        {
+            values.emplace_back(ConcreteElementB(data));
+            pointers.push_back(std::make_unique<classic::ConcreteElementB>(data));
+        }
+    }
+
+    CacheMissCounter misses;
+
+    misses.start();
+    auto start = std::chrono::steady_clock::now();
+    classic::SumVisitor classicVisitor;
+    for (auto &element : pointers)
+    {
+        element->accept(classicVisitor);
+    }
+    std::chrono::duration<double, std::nano> classicTime = std::chrono::steady_clock::now() - start;
+    std::string classicMisses = misses.stop();
+
+    misses.start();
+    start = std::chrono::steady_clock::now();
+    std::int64_t variantSum = 0;
+    visitAll(values, Overloaded{
+                         [&](const ConcreteElementA &element) { variantSum += element.value(); },
+                         [&](const ConcreteElementB &element) { variantSum += 3 * element.weight(); },
+                     });
+    std::chrono::duration<double, std::nano> variantTime = std::chrono::steady_clock::now() - start;
+    std::string variantMisses = misses.stop();
+
+    std::cout << "Classic double dispatch: " << classicTime.count() / count << " ns/element, "
+              << classicMisses << " cache misses" << std::endl;
+    std::cout << "std::variant + std::visit: " << variantTime.count() / count << " ns/element, "
+              << variantMisses << " cache misses" << std::endl;
+    std::cout << "Results " << (classicVisitor.sum == variantSum ? "match" : "DO NOT match") << std::endl;
+
+    return classicVisitor.sum == variantSum ? 0 : 1;
+}